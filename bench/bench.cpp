@@ -0,0 +1,289 @@
+// Emulator microbenchmarks: fixed workloads on a fresh machine, timed in
+// ns per tick.  Each runs a number of repetitions and keeps the fastest,
+// which is the least disturbed by whatever else the host is doing.
+//
+// Results go to a JSON file, one workload per line; with -b the run is
+// compared against a stored result file and fails when any workload got
+// slower by more than -t percent.  See "make bench" / "make bench-baseline".
+
+#include "emulator.h"
+#include "emu_tty.h"
+#include "n8_machine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+// ---- gui_console replacement (emulator/labels log through this) ----
+
+void gui_con_printmsg(char *msg) {
+    fprintf(stderr, "%s", msg);
+}
+void gui_con_printmsg(std::string data) {
+    fprintf(stderr, "%s", data.c_str());
+}
+
+// Workloads run their ticks in chunks; between chunks the feed (if any)
+// plays the host side, e.g. typing a character
+struct bench_t {
+    const char *name;
+    const char *desc;
+    void (*setup)();
+    void (*feed)();
+    bool run;           // emulator_run() in fast mode rather than emulator_step()
+};
+
+static const uint64_t CHUNK = 1000;
+
+static void load(uint16_t addr, const std::vector<uint8_t> &code) {
+    for(size_t i = 0; i < code.size(); i++) emulator_write_mem(addr + i, code[i]);
+}
+
+static void vectors(uint16_t reset, uint16_t irq) {
+    load(0xFFFA, { 0x00, 0xE0, (uint8_t)reset, (uint8_t)(reset >> 8),
+                   (uint8_t)irq, (uint8_t)(irq >> 8) });
+}
+
+// $E000-$EFFC: NOP ... JMP $E000
+static void setup_nop() {
+    std::vector<uint8_t> code(0xFFD, 0xEA);
+    code.insert(code.end(), { 0x4C, 0x00, 0xE0 });
+    load(0xE000, code);
+    vectors(0xE000, 0xE000);
+}
+
+// The firmware's TTY loop: poll in status, read, write out
+//   E000: LDA $C102; BEQ $E000; LDA $C103; STA $C101; JMP $E000
+static void setup_echo() {
+    load(0xE000, { 0xAD, 0x02, 0xC1, 0xF0, 0xFB, 0xAD, 0x03, 0xC1,
+                   0x8D, 0x01, 0xC1, 0x4C, 0x00, 0xE0 });
+    vectors(0xE000, 0xE000);
+}
+
+static void feed_char() {
+    if(tty_buff_count() == 0) tty_inject_char('x');
+}
+
+// Main loop counts while the TTY interrupt fires every chunk; the handler
+// reads the byte, which drops the line
+//   E000: CLI; loop: INX; JMP loop
+//   E100: PHA; LDA $C103; PLA; RTI
+static void setup_irq() {
+    load(0xE000, { 0x58, 0xE8, 0x4C, 0x01, 0xE0 });
+    load(0xE100, { 0x48, 0xAD, 0x03, 0xC1, 0x68, 0x40 });
+    vectors(0xE000, 0xE100);
+}
+
+static void feed_irq() {
+    tty_inject_char('x');
+}
+
+// Copy $0400-$3FFF to $4000-$7BFF, a page at a time through ($10),Y / ($12),Y
+//   E000: LDA #0; STA $10; STA $12; LDA #4; STA $11; LDA #$40; STA $13
+//   E00E: LDY #0
+//   E010: LDA ($10),Y; STA ($12),Y; INY; BNE $E010
+//   E017: INC $11; INC $13; LDA $11; CMP #$40; BNE $E00E; JMP $E000
+static void setup_memcpy() {
+    load(0xE000, { 0xA9, 0x00, 0x85, 0x10, 0x85, 0x12, 0xA9, 0x04, 0x85, 0x11,
+                   0xA9, 0x40, 0x85, 0x13, 0xA0, 0x00, 0xB1, 0x10, 0x91, 0x12,
+                   0xC8, 0xD0, 0xF9, 0xE6, 0x11, 0xE6, 0x13, 0xA5, 0x11, 0xC9,
+                   0x40, 0xD0, 0xED, 0x4C, 0x00, 0xE0 });
+    vectors(0xE000, 0xE000);
+}
+
+// Same copy with breakpoints enabled and armed on the loop's page (and
+// the pages it reads and writes), none of them ever hit
+static void setup_memcpy_bp() {
+    setup_memcpy();
+    emulator_dbg_set(0xE080, DBG_EXEC);
+    emulator_dbg_set(0x0401, DBG_EXEC);
+    emulator_dbg_set(0x4001, DBG_EXEC);
+    emulator_enablebp(true);
+}
+
+static const bench_t benches[] = {
+    { "nop",         "NOP sled",                               setup_nop,       nullptr,   false },
+    { "tty_echo",    "TTY echo loop, a character per chunk",   setup_echo,      feed_char, false },
+    { "irq",         "TTY interrupt every chunk",              setup_irq,       feed_irq,  false },
+    { "memcpy",      "indirect indexed page copy",             setup_memcpy,    nullptr,   false },
+    { "memcpy_bp",   "page copy, breakpoints armed",           setup_memcpy_bp, nullptr,   false },
+    { "nop_fast",    "NOP sled, emulator_run() fast mode",     setup_nop,       nullptr,   true  },
+    { "memcpy_fast", "page copy, emulator_run() fast mode",    setup_memcpy,    nullptr,   true  },
+};
+
+struct result_t {
+    std::string name;
+    uint64_t ticks;
+    double ns_per_tick;
+};
+
+static void run_ticks(const bench_t &b, uint64_t ticks) {
+    for(uint64_t done = 0; done < ticks; done += CHUNK) {
+        if(b.feed) b.feed();
+        if(b.run) {
+            emulator_run(CHUNK, nullptr);
+        } else {
+            for(uint64_t i = 0; i < CHUNK; i++) emulator_step();
+        }
+    }
+}
+
+static result_t measure(const bench_t &b, uint64_t ticks, int reps) {
+    N8Machine *m = n8_machine_new();
+    N8Machine *prev = n8_machine_bind(m);
+    b.setup();
+    emulator_enablefast(b.run);
+    emulator_enableidle(false);
+    run_ticks(b, ticks / 10);      // boot, warm caches and fast blocks
+
+    double best = 0.0;
+    for(int r = 0; r < reps; r++) {
+        const uint64_t t0 = emulator_ticks();
+        auto c0 = std::chrono::steady_clock::now();
+        run_ticks(b, ticks);
+        auto c1 = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(c1 - c0).count() /
+                          (double)(emulator_ticks() - t0);
+        if(r == 0 || ns < best) best = ns;
+    }
+    n8_machine_bind(prev);
+    n8_machine_free(m);
+    return { b.name, ticks, best };
+}
+
+static bool save(const char *path, const std::vector<result_t> &results) {
+    FILE *f = fopen(path, "w");
+    if(!f) return false;
+    fprintf(f, "[\n");
+    for(size_t i = 0; i < results.size(); i++) {
+        const result_t &r = results[i];
+        fprintf(f, "  {\"name\": \"%s\", \"ticks\": %llu, \"ns_per_tick\": %.3f, \"mhz\": %.2f}%s\n",
+                r.name.c_str(), (unsigned long long)r.ticks, r.ns_per_tick,
+                1000.0 / r.ns_per_tick, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "]\n");
+    return fclose(f) == 0;
+}
+
+// Reads back what save() writes: name -> ns per tick
+static bool load_baseline(const char *path, std::map<std::string, double> &out) {
+    FILE *f = fopen(path, "r");
+    if(!f) return false;
+    char line[512], name[64];
+    double ns;
+    while(fgets(line, sizeof(line), f)) {
+        const char *p = strstr(line, "\"name\": \""), *q = strstr(line, "\"ns_per_tick\": ");
+        if(!p || !q) continue;
+        if(sscanf(p + 9, "%63[^\"]", name) == 1 && sscanf(q + 15, "%lf", &ns) == 1) out[name] = ns;
+    }
+    fclose(f);
+    return true;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options] [workload ...]\n"
+        "  -n N      ticks per repetition (default 10000000)\n"
+        "  -k N      repetitions, the fastest counts (default 3)\n"
+        "  -o FILE   write results as JSON (default bench.json)\n"
+        "  -b FILE   compare with a previous result file\n"
+        "  -t PCT    with -b: fail if any workload is PCT%% slower (default 10)\n"
+        "  -l        list workloads\n", prog);
+}
+
+int main(int argc, char **argv) {
+    uint64_t ticks = 10000000;
+    int reps = 3;
+    const char *out_file = "bench.json";
+    const char *base_file = nullptr;
+    double threshold = 10.0;
+    std::vector<const bench_t *> selected;
+
+    for(int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if(strcmp(arg, "-l") == 0) {
+            for(const bench_t &b : benches) printf("%-12s %s\n", b.name, b.desc);
+            return 0;
+        }
+        if(arg[0] != '-') {
+            const bench_t *found = nullptr;
+            for(const bench_t &b : benches) {
+                if(strcmp(b.name, arg) == 0) found = &b;
+            }
+            if(!found) {
+                fprintf(stderr, "unknown workload: %s\n", arg);
+                return 1;
+            }
+            selected.push_back(found);
+            continue;
+        }
+        if(arg[1] == 0 || arg[2] != 0 || i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char *val = argv[++i];
+        switch(arg[1]) {
+            case 'n': ticks = strtoull(val, nullptr, 0); break;
+            case 'k': reps = atoi(val); break;
+            case 'o': out_file = val; break;
+            case 'b': base_file = val; break;
+            case 't': threshold = atof(val); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if(ticks < CHUNK || reps < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if(selected.empty()) {
+        for(const bench_t &b : benches) selected.push_back(&b);
+    }
+
+    std::map<std::string, double> base;
+    if(base_file && !load_baseline(base_file, base)) {
+        fprintf(stderr, "can't read %s\n", base_file);
+        return 1;
+    }
+
+    // The TTY workloads write to stdout; keep it off the terminal
+    if(!freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "can't redirect stdout\n");
+        return 1;
+    }
+
+    std::vector<result_t> results;
+    int regressed = 0;
+    fprintf(stderr, "%-12s %10s %9s", "workload", "ns/tick", "MHz");
+    fprintf(stderr, base_file ? " %10s %8s\n" : "\n", "baseline", "change");
+    for(const bench_t *b : selected) {
+        const result_t r = measure(*b, ticks, reps);
+        results.push_back(r);
+        fprintf(stderr, "%-12s %10.3f %9.2f", r.name.c_str(), r.ns_per_tick, 1000.0 / r.ns_per_tick);
+        auto it = base.find(r.name);
+        if(it != base.end()) {
+            const double change = 100.0 * (r.ns_per_tick - it->second) / it->second;
+            const bool bad = change > threshold;
+            regressed += bad;
+            fprintf(stderr, " %10.3f %+7.1f%%%s", it->second, change, bad ? "  REGRESSED" : "");
+        } else if(base_file) {
+            fprintf(stderr, " %10s", "-");
+        }
+        fprintf(stderr, "\n");
+    }
+
+    if(!save(out_file, results)) {
+        fprintf(stderr, "can't write %s\n", out_file);
+        return 1;
+    }
+    if(regressed) {
+        fprintf(stderr, "%d workload(s) more than %.1f%% slower than %s\n", regressed, threshold, base_file);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// Bus internals shared by emulator.cpp and the fast interpreter
+// (emu_fast6502.cpp).  Everything else goes through emulator.h.
+
+#include "emulator.h"
+#include "emu_fast6502.h"
+#include "n8_machine.h"
+
+// Both take the machine (an N8Machine&, normally *n8) so per-cycle code
+// can hold it in a local.
+
+// Page has at least one armed debug flag (see DBG_ARMED)
+#define DBG_PAGE_ARMED(m, addr) ((m).dbg_pages[(addr) >> 14] & (1ull << (((addr) >> 8) & 63)))
+
+// Stamp the page of a written address with the current generation and drop
+// any cached blocks decoded from it
+#define MEM_TOUCH(m, addr) do {                                         \
+        (m).mem_page_gen[(addr) >> 8] = (m).mem_gen;                    \
+        if ((m).bb_code_pages[(addr) >> 8]) emu_fast6502_invalidate((addr) >> 8); \
+    } while (0)
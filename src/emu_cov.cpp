@@ -0,0 +1,182 @@
+// Code coverage, see emu_cov.h.
+
+#include "emu_cov.h"
+#include "n8_machine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+void emu_cov_enable(bool en) {
+    delete n8->cov;
+    n8->cov = en ? new emu_cov_t() : nullptr;
+}
+
+bool emu_cov_enabled() {
+    return n8->cov != nullptr;
+}
+
+void emu_cov_clear() {
+    if (!n8->cov) return;
+    memset(n8->cov->hits, 0, sizeof(n8->cov->hits));
+    n8->cov->branch = false;
+}
+
+const uint8_t *emu_cov_hits() {
+    return n8->cov ? n8->cov->hits : nullptr;
+}
+
+// ---- ld65 debug info ----
+//
+// One record per line: a keyword, a tab, then comma separated key=value
+// attributes, strings quoted.  Used here:
+//   file  id=0,name="main.s",...
+//   seg   id=0,name="CODE",start=0x00D000,size=0x0123,...
+//   span  id=0,seg=0,start=0,size=3[,type=N]     type: a data declaration
+//   line  id=0,file=0,line=37[,type=2][,span=3+4] type 2: inside a macro
+
+typedef std::map<std::string, std::string> dbg_attrs_t;
+
+static void dbg_parse(const char *s, dbg_attrs_t &attrs) {
+    attrs.clear();
+    while (*s) {
+        const char *eq = strchr(s, '=');
+        if (!eq) return;
+        std::string key(s, eq - s), val;
+        s = eq + 1;
+        if (*s == '"') {
+            for (s++; *s && *s != '"'; s++) val += *s;
+            if (*s) s++;
+        } else {
+            while (*s && *s != ',' && *s != '\n' && *s != '\r') val += *s++;
+        }
+        attrs[key] = val;
+        if (*s == ',') s++;
+        else if (*s) return;
+    }
+}
+
+static long dbg_num(const dbg_attrs_t &attrs, const char *key, long def = -1) {
+    auto it = attrs.find(key);
+    return it == attrs.end() ? def : strtol(it->second.c_str(), nullptr, 0);
+}
+
+bool emu_cov_load_dbg(const char *path, emu_cov_map_t &map) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return false;
+
+    struct span_t { long seg, start, size; bool data; };
+    struct line_t { long file, line; std::string spans; };
+    std::map<long, std::string> files;
+    std::map<long, long> segs;
+    std::map<long, span_t> spans;
+    std::vector<line_t> lines;
+
+    char buf[4096];
+    dbg_attrs_t a;
+    while (fgets(buf, sizeof(buf), fp)) {
+        char *tab = strchr(buf, '\t');
+        if (!tab) continue;
+        *tab = 0;
+        dbg_parse(tab + 1, a);
+        if (!strcmp(buf, "file")) {
+            files[dbg_num(a, "id")] = a["name"];
+        } else if (!strcmp(buf, "seg")) {
+            segs[dbg_num(a, "id")] = dbg_num(a, "start");
+        } else if (!strcmp(buf, "span")) {
+            spans[dbg_num(a, "id")] = { dbg_num(a, "seg"), dbg_num(a, "start"), dbg_num(a, "size"),
+                                        a.count("type") != 0 };
+        } else if (!strcmp(buf, "line") && a.count("span") && dbg_num(a, "type", 0) != 2) {
+            lines.push_back({ dbg_num(a, "file"), dbg_num(a, "line"), a["span"] });
+        }
+    }
+    fclose(fp);
+
+    // Source names are relative to where the firmware was built, which is
+    // where the debug info file is
+    std::string dir(path);
+    const size_t slash = dir.find_last_of('/');
+    dir = slash == std::string::npos ? "" : dir.substr(0, slash + 1);
+
+    map.files.clear();
+    map.lines.clear();
+    std::map<long, int> file_index;
+    for (const auto &f : files) {
+        file_index[f.first] = (int)map.files.size();
+        map.files.push_back(f.second.empty() || f.second[0] == '/' ? f.second : dir + f.second);
+    }
+    for (const line_t &l : lines) {
+        if (!file_index.count(l.file)) continue;
+        for (const char *s = l.spans.c_str(); *s; ) {
+            char *end;
+            const long id = strtol(s, &end, 10);
+            if (end == s) break;
+            s = *end == '+' ? end + 1 : end;
+            auto sp = spans.find(id);
+            if (sp == spans.end() || sp->second.data || sp->second.size <= 0) continue;
+            auto seg = segs.find(sp->second.seg);
+            if (seg == segs.end()) continue;
+            map.lines.push_back({ file_index[l.file], (int)l.line,
+                                  (uint16_t)(seg->second + sp->second.start), (uint16_t)sp->second.size });
+        }
+    }
+    std::stable_sort(map.lines.begin(), map.lines.end(), [](const emu_cov_line_t &x, const emu_cov_line_t &y) {
+        return x.file != y.file ? x.file < y.file : x.line != y.line ? x.line < y.line : x.addr < y.addr;
+    });
+    return true;
+}
+
+// ---- lcov ----
+
+bool emu_cov_lcov(const char *path, const emu_cov_map_t &map, const uint8_t *hits, const uint8_t *mem) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "TN:\n");
+
+    size_t i = 0;
+    while (i < map.lines.size()) {
+        const int file = map.lines[i].file;
+        int lf = 0, lh = 0, brf = 0, brh = 0;
+        fprintf(f, "SF:%s\n", map.files[file].c_str());
+        while (i < map.lines.size() && map.lines[i].file == file) {
+            // All the code one source line assembled to
+            const int line = map.lines[i].line;
+            bool hit = false;
+            std::vector<uint16_t> branches;
+            for (; i < map.lines.size() && map.lines[i].file == file && map.lines[i].line == line; i++) {
+                const emu_cov_line_t &l = map.lines[i];
+                for (uint32_t a = l.addr; a < (uint32_t)l.addr + l.size; a++) {
+                    const bool ran = (hits[(uint16_t)a] & EMU_COV_EXEC) != 0;
+                    hit |= ran;
+                    // Branches that ran, and one that didn't making up the whole span
+                    if (emu_cov_is_branch(mem[(uint16_t)a]) && (ran || (a == l.addr && l.size == 2))) {
+                        branches.push_back((uint16_t)a);
+                    }
+                }
+            }
+            lf++;
+            lh += hit;
+            fprintf(f, "DA:%d,%d\n", line, hit ? 1 : 0);
+            for (size_t b = 0; b < branches.size(); b++) {
+                const uint8_t h = hits[branches[b]];
+                const uint8_t outcome[2] = { EMU_COV_TAKEN, EMU_COV_NOT_TAKEN };
+                for (int k = 0; k < 2; k++) {
+                    brf++;
+                    if (!(h & EMU_COV_EXEC)) {
+                        fprintf(f, "BRDA:%d,%zu,%d,-\n", line, b, k);
+                    } else {
+                        const bool taken = (h & outcome[k]) != 0;
+                        brh += taken;
+                        fprintf(f, "BRDA:%d,%zu,%d,%d\n", line, b, k, taken ? 1 : 0);
+                    }
+                }
+            }
+        }
+        fprintf(f, "BRF:%d\nBRH:%d\nLF:%d\nLH:%d\nend_of_record\n", brf, brh, lf, lh);
+    }
+    return fclose(f) == 0;
+}
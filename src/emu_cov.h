@@ -0,0 +1,76 @@
+#pragma once
+
+// Code coverage: one byte of EMU_COV_* bits per address, set at each
+// opcode fetch and, for conditional branches, once the outcome is known.
+// Only ever ORs bits in, so it is cheap enough to leave on for a whole
+// regression run: fast mode keeps running cached blocks and marks each
+// instruction as it goes.  Re-running (rewind) changes nothing.
+//
+// Off by default.  Acts on the calling thread's machine (N8Machine::cov).
+//
+// Export maps addresses to source lines through the ld65 debug info file
+// (cl65 -g -Wl --dbgfile,FILE, see firmware/Makefile) and writes lcov
+// tracefile records: a line is hit if any of its code bytes was fetched
+// as an opcode; each branch gets a taken and a not-taken entry.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define EMU_COV_EXEC        0x01
+#define EMU_COV_TAKEN       0x02
+#define EMU_COV_NOT_TAKEN   0x04
+
+struct emu_cov_t {
+    uint8_t  hits[1 << 16];
+    uint16_t pc;            // branch in flight (tick core)
+    uint16_t target;        // ... and where it goes if taken
+    bool     branch;
+};
+
+void emu_cov_enable(bool en);       // starts from zero
+bool emu_cov_enabled();
+void emu_cov_clear();
+const uint8_t *emu_cov_hits();      // 64K EMU_COV_* bytes, nullptr while off
+
+// One source line with the code it assembled to, from the debug info
+struct emu_cov_line_t {
+    int      file;              // into emu_cov_map_t::files
+    int      line;
+    uint16_t addr, size;
+};
+
+struct emu_cov_map_t {
+    std::vector<std::string>    files;      // relative names resolved against the dbg file's directory
+    std::vector<emu_cov_line_t> lines;      // code only, by file then line
+};
+
+bool emu_cov_load_dbg(const char *path, emu_cov_map_t &map);
+// lcov tracefile; mem is the memory image the hits were taken from (to
+// find branches that never ran)
+bool emu_cov_lcov(const char *path, const emu_cov_map_t &map, const uint8_t *hits, const uint8_t *mem);
+
+static inline bool emu_cov_is_branch(uint8_t op) {
+    return (op & 0x1F) == 0x10;
+}
+
+// Bus path, at a SYNC cycle: settles the branch fetched before, if any.
+// Anything other than its two destinations (an interrupt) settles nothing.
+static inline void emu_cov_fetch(emu_cov_t &c, uint16_t pc, uint8_t op, uint8_t operand) {
+    if (c.branch) {
+        if (pc == (uint16_t)(c.pc + 2)) c.hits[c.pc] |= EMU_COV_NOT_TAKEN;
+        else if (pc == c.target)        c.hits[c.pc] |= EMU_COV_TAKEN;
+    }
+    c.hits[pc] |= EMU_COV_EXEC;
+    c.branch = emu_cov_is_branch(op);
+    c.pc = pc;
+    c.target = (uint16_t)(pc + 2 + (int8_t)operand);
+}
+
+// Fast interpreter, per instruction run: next is the PC it left behind
+static inline void emu_cov_exec(emu_cov_t &c, uint16_t pc, uint8_t op, uint16_t next) {
+    uint8_t bits = EMU_COV_EXEC;
+    if (emu_cov_is_branch(op)) bits |= next == (uint16_t)(pc + 2) ? EMU_COV_NOT_TAKEN : EMU_COV_TAKEN;
+    c.hits[pc] |= bits;
+    c.branch = false;
+}
@@ -1,12 +1,16 @@
 
 #include "emu_dis6502.h"
 #include "emulator.h"
+#include "n8_machine.h"
+#include "emu_thread.h"
 #include "emu_tty.h"
 #include "emu_labels.h"
 #include "gui_console.h"
 #include "utils.h"
 #include "machine.h"
 
+#include <math.h>
+#include <algorithm>
 #include <string>
 #include <list>
 
@@ -52,8 +56,17 @@ const int opcode_props[256][3] = {
     {2,5,8}, {2,44,5},{1,57,0},{1,57,0},{1,57,0},{2,44,2},{2,24,2},{1,57,0},{1,46,0},{3,44,3},{1,57,0},{1,57,0},{1,57,0},{3,44,2},{3,24,2},{1,57,0}  // F
 };
 
+// Memory the disassembler reads: live mem[] by default, the published
+// snapshot when drawing from the GUI thread.
+static const uint8_t *dis_mem = nullptr;   // nullptr: the thread's machine
+
+void emu_dis6502_set_source(const uint8_t *src) {
+    dis_mem = src;
+}
+
 // 
 int emu_dis6502_decode(int addr,char *menomic, int m_len) { 
+    const uint8_t *mem = dis_mem ? dis_mem : n8->mem;
     int inst_len, addrmode;
     const char *opcode, *pre, *post;// *pad;
     // char output[512] {0};
@@ -98,6 +111,7 @@ int emu_dis6502_decode(int addr,char *menomic, int m_len) {
 }
 
 void emu_dis6502_log(char * args) {
+    const uint8_t *mem = dis_mem ? dis_mem : n8->mem;
     char console_msg[1256] {0};
     char decode[256] {0};
     char mem_dump[16] {0};  // should only need 9
@@ -160,7 +174,9 @@ void emu_dis6502_window(bool show_window) {
     char mem_dump[16] {0};  // should only need 9
     char *cur;
 
-    uint16_t ci = emulator_getci();
+    const emu_snapshot_t &snap = *emu_thread_snapshot();
+    const uint8_t *mem = snap.mem;
+    uint16_t ci = snap.ci;
     if(last_ci != ci) last_ci = ci;
 
     int ci_line=0, cur_line = 0;
@@ -177,6 +193,14 @@ void emu_dis6502_window(bool show_window) {
 
     ImGui::BeginChild("dis",ImVec2(0,-25.0));
 
+    // Profile heat: white (cold) to red (hottest), log scale
+    double heat_scale = 0.0;
+    if(snap.prof_on) {
+        uint32_t hottest = 0;
+        for(int i = 0; i < 65536; i++) hottest = std::max(hottest, snap.prof[i]);
+        if(hottest > 1) heat_scale = 1.0 / log((double)hottest);
+    }
+
     cur = mem_range;
 
     while(*cur) {
@@ -213,12 +237,20 @@ void emu_dis6502_window(bool show_window) {
             }
             char buff[256] {0};
             snprintf(buff,256, "%4.4x:",start_addr);
-            if(ImGui::Checkbox(buff, &bp_mask[start_addr])){;;}
+            bool bp = (snap.dbg_flags[start_addr] & DBG_EXEC) != 0;
+            if(ImGui::Checkbox(buff, &bp)) {
+                emu_thread_post(bp ? EMU_CMD_BP_SET : EMU_CMD_BP_CLEAR, start_addr);
+            }
             ImGui::SameLine();
             if( last_ci >= start_addr && last_ci < (start_addr+len)) { // current instruction
                 ImGui::TextColored(ImVec4(0.0f,1.0f,0.0f,1.0f),"  %-12s  %s", mem_dump, decode);
                 ci_line=cur_line;
             }
+            else if(heat_scale > 0.0 && snap.prof[start_addr] > 0) {
+                float heat = (float)std::min(1.0, log((double)snap.prof[start_addr]) * heat_scale);
+                ImGui::TextColored(ImVec4(1.0f, 1.0f - 0.8f * heat, 1.0f - 0.8f * heat, 1.0f),
+                                   "  %-12s  %s", mem_dump, decode);
+            }
             else {
                 ImGui::Text("  %-12s  %s", mem_dump, decode);
             }
@@ -1,8 +1,11 @@
 
 #pragma once
 
+#include <cstdint>
+
 
 void emu_dis6502_init();
+void emu_dis6502_set_source(const uint8_t *src);
 // void emu_dis6502_decode(int);
 int emu_dis6502_decode(int, char *, int);
 void emu_dis6502_log(char * args);
@@ -0,0 +1,565 @@
+// Instruction-level interpreter, see emu_fast6502.h.
+//
+// Each instruction is split in two passes: resolve the addressing mode and
+// check every page the tick core would touch (so a declined instruction has
+// no side effects), then execute.  Flag helpers mirror the ones in m6502.h,
+// including decimal mode, so results match the tick core bit for bit.
+//
+// Instructions run on a local copy of the registers (fast_cpu_t) that is
+// written back once per instruction or block, and N/Z are kept as the last
+// result and only folded into P when something reads them.
+
+#include "emu_fast6502.h"
+#include "emu_bus.h"
+#include "emu_cov.h"
+
+typedef enum {
+    AM_NONE,    // not handled: leave to the tick core
+    AM_IMP, AM_IMM, AM_ZP, AM_ZPX, AM_ZPY, AM_ABS, AM_ABX, AM_ABY,
+    AM_IZX, AM_IZY, AM_IND, AM_REL
+} fast_mode_t;
+
+typedef struct {
+    uint8_t mode;       // fast_mode_t
+    uint8_t cycles;     // base cycle count
+    uint8_t penalty;    // +1 cycle when indexing crosses a page (reads only)
+} fast_op_t;
+
+#define OP(m, c)  { m, c, 0 }
+#define OPP(m, c) { m, c, 1 }
+#define XX        { AM_NONE, 0, 0 }
+
+static const fast_op_t fast_ops[256] = {
+    /* 00 */ XX,             OP(AM_IZX,6),  XX, XX, XX,            OP(AM_ZP,3),   OP(AM_ZP,5),   XX,
+    /* 08 */ OP(AM_IMP,3),   OP(AM_IMM,2),  OP(AM_IMP,2), XX, XX,  OP(AM_ABS,4),  OP(AM_ABS,6),  XX,
+    /* 10 */ OP(AM_REL,2),   OPP(AM_IZY,5), XX, XX, XX,            OP(AM_ZPX,4),  OP(AM_ZPX,6),  XX,
+    /* 18 */ OP(AM_IMP,2),   OPP(AM_ABY,4), XX, XX, XX,            OPP(AM_ABX,4), OP(AM_ABX,7),  XX,
+    /* 20 */ OP(AM_ABS,6),   OP(AM_IZX,6),  XX, XX, OP(AM_ZP,3),   OP(AM_ZP,3),   OP(AM_ZP,5),   XX,
+    /* 28 */ XX,             OP(AM_IMM,2),  OP(AM_IMP,2), XX, OP(AM_ABS,4), OP(AM_ABS,4), OP(AM_ABS,6), XX,
+    /* 30 */ OP(AM_REL,2),   OPP(AM_IZY,5), XX, XX, XX,            OP(AM_ZPX,4),  OP(AM_ZPX,6),  XX,
+    /* 38 */ OP(AM_IMP,2),   OPP(AM_ABY,4), XX, XX, XX,            OPP(AM_ABX,4), OP(AM_ABX,7),  XX,
+    /* 40 */ XX,             OP(AM_IZX,6),  XX, XX, XX,            OP(AM_ZP,3),   OP(AM_ZP,5),   XX,
+    /* 48 */ OP(AM_IMP,3),   OP(AM_IMM,2),  OP(AM_IMP,2), XX, OP(AM_ABS,3), OP(AM_ABS,4), OP(AM_ABS,6), XX,
+    /* 50 */ OP(AM_REL,2),   OPP(AM_IZY,5), XX, XX, XX,            OP(AM_ZPX,4),  OP(AM_ZPX,6),  XX,
+    /* 58 */ XX,             OPP(AM_ABY,4), XX, XX, XX,            OPP(AM_ABX,4), OP(AM_ABX,7),  XX,
+    /* 60 */ OP(AM_IMP,6),   OP(AM_IZX,6),  XX, XX, XX,            OP(AM_ZP,3),   OP(AM_ZP,5),   XX,
+    /* 68 */ OP(AM_IMP,4),   OP(AM_IMM,2),  OP(AM_IMP,2), XX, OP(AM_IND,5), OP(AM_ABS,4), OP(AM_ABS,6), XX,
+    /* 70 */ OP(AM_REL,2),   OPP(AM_IZY,5), XX, XX, XX,            OP(AM_ZPX,4),  OP(AM_ZPX,6),  XX,
+    /* 78 */ XX,             OPP(AM_ABY,4), XX, XX, XX,            OPP(AM_ABX,4), OP(AM_ABX,7),  XX,
+    /* 80 */ XX,             OP(AM_IZX,6),  XX, XX, OP(AM_ZP,3),   OP(AM_ZP,3),   OP(AM_ZP,3),   XX,
+    /* 88 */ OP(AM_IMP,2),   XX,            OP(AM_IMP,2), XX, OP(AM_ABS,4), OP(AM_ABS,4), OP(AM_ABS,4), XX,
+    /* 90 */ OP(AM_REL,2),   OP(AM_IZY,6),  XX, XX, OP(AM_ZPX,4),  OP(AM_ZPX,4),  OP(AM_ZPY,4),  XX,
+    /* 98 */ OP(AM_IMP,2),   OP(AM_ABY,5),  OP(AM_IMP,2), XX, XX,  OP(AM_ABX,5),  XX,            XX,
+    /* A0 */ OP(AM_IMM,2),   OP(AM_IZX,6),  OP(AM_IMM,2), XX, OP(AM_ZP,3), OP(AM_ZP,3), OP(AM_ZP,3), XX,
+    /* A8 */ OP(AM_IMP,2),   OP(AM_IMM,2),  OP(AM_IMP,2), XX, OP(AM_ABS,4), OP(AM_ABS,4), OP(AM_ABS,4), XX,
+    /* B0 */ OP(AM_REL,2),   OPP(AM_IZY,5), XX, XX, OP(AM_ZPX,4),  OP(AM_ZPX,4),  OP(AM_ZPY,4),  XX,
+    /* B8 */ OP(AM_IMP,2),   OPP(AM_ABY,4), OP(AM_IMP,2), XX, OPP(AM_ABX,4), OPP(AM_ABX,4), OPP(AM_ABY,4), XX,
+    /* C0 */ OP(AM_IMM,2),   OP(AM_IZX,6),  XX, XX, OP(AM_ZP,3),   OP(AM_ZP,3),   OP(AM_ZP,5),   XX,
+    /* C8 */ OP(AM_IMP,2),   OP(AM_IMM,2),  OP(AM_IMP,2), XX, OP(AM_ABS,4), OP(AM_ABS,4), OP(AM_ABS,6), XX,
+    /* D0 */ OP(AM_REL,2),   OPP(AM_IZY,5), XX, XX, XX,            OP(AM_ZPX,4),  OP(AM_ZPX,6),  XX,
+    /* D8 */ OP(AM_IMP,2),   OPP(AM_ABY,4), XX, XX, XX,            OPP(AM_ABX,4), OP(AM_ABX,7),  XX,
+    /* E0 */ OP(AM_IMM,2),   OP(AM_IZX,6),  XX, XX, OP(AM_ZP,3),   OP(AM_ZP,3),   OP(AM_ZP,5),   XX,
+    /* E8 */ OP(AM_IMP,2),   OP(AM_IMM,2),  OP(AM_IMP,2), XX, OP(AM_ABS,4), OP(AM_ABS,4), OP(AM_ABS,6), XX,
+    /* F0 */ OP(AM_REL,2),   OPP(AM_IZY,5), XX, XX, XX,            OP(AM_ZPX,4),  OP(AM_ZPX,6),  XX,
+    /* F8 */ OP(AM_IMP,2),   OPP(AM_ABY,4), XX, XX, XX,            OPP(AM_ABX,4), OP(AM_ABX,7),  XX,
+};
+
+#undef OP
+#undef OPP
+#undef XX
+
+// Register file while executing.  N and Z are not kept in P: nz holds the
+// last result, Z = low byte is zero, N = bit 7 of (low | high).  The high
+// byte only encodes the N+Z combination BIT can produce.
+typedef struct {
+    uint8_t  A, X, Y, S, P;
+    uint16_t PC;
+    uint16_t nz;
+    bool     bcd_enabled;
+} fast_cpu_t;
+
+static inline void set_nz(fast_cpu_t *c, bool n, bool z) {
+    c->nz = z ? (n ? 0x8000 : 0x0000) : (n ? 0x0080 : 0x0001);
+}
+
+static inline bool flag_n(const fast_cpu_t *c) { return ((c->nz | (c->nz >> 8)) & 0x80) != 0; }
+static inline bool flag_z(const fast_cpu_t *c) { return (c->nz & 0xFF) == 0; }
+
+// P with N/Z folded back in
+static inline uint8_t flags_p(const fast_cpu_t *c) {
+    return (c->P & ~(M6502_NF | M6502_ZF)) | (flag_n(c) ? M6502_NF : 0) | (flag_z(c) ? M6502_ZF : 0);
+}
+
+static inline void load_cpu(fast_cpu_t *f, const m6502_t *c) {
+    f->A = c->A; f->X = c->X; f->Y = c->Y; f->S = c->S; f->P = c->P;
+    f->PC = c->PC;
+    f->bcd_enabled = c->bcd_enabled;
+    set_nz(f, c->P & M6502_NF, c->P & M6502_ZF);
+}
+
+static inline void store_cpu(m6502_t *c, const fast_cpu_t *f) {
+    c->A = f->A; c->X = f->X; c->Y = f->Y; c->S = f->S;
+    c->P = flags_p(f);
+    c->PC = f->PC;
+}
+
+// ---- Memory ----
+
+// Everything below works on an explicit machine (the caller's n8), so the
+// hot paths read the thread-local pointer once.
+
+// True if the page holding addr can be accessed without going through the bus
+static inline bool page_ok(const N8Machine &m, uint16_t addr) {
+    return !m.page_table[addr >> 8].io && !DBG_PAGE_ARMED(m, addr);
+}
+
+static inline void wr(N8Machine &m, uint16_t addr, uint8_t v) {
+    m.cpu_writes++;
+    if (!m.page_table[addr >> 8].rom) {
+        m.mem[addr] = v;
+        MEM_TOUCH(m, addr);
+    }
+}
+
+static inline void push(N8Machine &m, fast_cpu_t *c, uint8_t v) {
+    wr(m, 0x0100 | c->S--, v);
+}
+
+static inline uint8_t pull(N8Machine &m, fast_cpu_t *c) {
+    return m.mem[0x0100 | ++c->S];
+}
+
+// ---- Flags (same semantics as the helpers in m6502.h) ----
+
+#define NZ(v) c->nz = (uint8_t)(v)
+
+static void adc(fast_cpu_t *c, uint8_t val) {
+    if (c->bcd_enabled && (c->P & M6502_DF)) {
+        uint8_t cy = c->P & M6502_CF ? 1 : 0;
+        c->P &= ~(M6502_VF | M6502_CF);
+        uint8_t al = (c->A & 0x0F) + (val & 0x0F) + cy;
+        if (al > 9) al += 6;
+        uint8_t ah = (c->A >> 4) + (val >> 4) + (al > 0x0F);
+        const bool z = (0 == (uint8_t)(c->A + val + cy));
+        set_nz(c, !z && (ah & 0x08), z);
+        if (~(c->A ^ val) & (c->A ^ (ah << 4)) & 0x80) c->P |= M6502_VF;
+        if (ah > 9) ah += 6;
+        if (ah > 15) c->P |= M6502_CF;
+        c->A = (ah << 4) | (al & 0x0F);
+    } else {
+        uint16_t sum = c->A + val + (c->P & M6502_CF ? 1 : 0);
+        c->P &= ~(M6502_VF | M6502_CF);
+        NZ(sum);
+        if (~(c->A ^ val) & (c->A ^ sum) & 0x80) c->P |= M6502_VF;
+        if (sum & 0xFF00) c->P |= M6502_CF;
+        c->A = sum & 0xFF;
+    }
+}
+
+static void sbc(fast_cpu_t *c, uint8_t val) {
+    if (c->bcd_enabled && (c->P & M6502_DF)) {
+        uint8_t cy = c->P & M6502_CF ? 0 : 1;
+        c->P &= ~(M6502_VF | M6502_CF);
+        uint16_t diff = c->A - val - cy;
+        uint8_t al = (c->A & 0x0F) - (val & 0x0F) - cy;
+        if ((int8_t)al < 0) al -= 6;
+        uint8_t ah = (c->A >> 4) - (val >> 4) - ((int8_t)al < 0);
+        NZ(diff);
+        if ((c->A ^ val) & (c->A ^ diff) & 0x80) c->P |= M6502_VF;
+        if (!(diff & 0xFF00)) c->P |= M6502_CF;
+        if (ah & 0x80) ah -= 6;
+        c->A = (ah << 4) | (al & 0x0F);
+    } else {
+        uint16_t diff = c->A - val - (c->P & M6502_CF ? 0 : 1);
+        c->P &= ~(M6502_VF | M6502_CF);
+        NZ(diff);
+        if ((c->A ^ val) & (c->A ^ diff) & 0x80) c->P |= M6502_VF;
+        if (!(diff & 0xFF00)) c->P |= M6502_CF;
+        c->A = diff & 0xFF;
+    }
+}
+
+static inline void cmp(fast_cpu_t *c, uint8_t r, uint8_t v) {
+    uint16_t t = r - v;
+    NZ((uint8_t)t);
+    c->P = (c->P & ~M6502_CF) | ((t & 0xFF00) ? 0 : M6502_CF);
+}
+
+static inline uint8_t asl(fast_cpu_t *c, uint8_t v) {
+    c->P = (c->P & ~M6502_CF) | ((v & 0x80) ? M6502_CF : 0);
+    v <<= 1; NZ(v);
+    return v;
+}
+
+static inline uint8_t lsr(fast_cpu_t *c, uint8_t v) {
+    c->P = (c->P & ~M6502_CF) | ((v & 0x01) ? M6502_CF : 0);
+    v >>= 1; NZ(v);
+    return v;
+}
+
+static inline uint8_t rol(fast_cpu_t *c, uint8_t v) {
+    bool carry = c->P & M6502_CF;
+    c->P = (c->P & ~M6502_CF) | ((v & 0x80) ? M6502_CF : 0);
+    v = (v << 1) | (carry ? 0x01 : 0);
+    NZ(v);
+    return v;
+}
+
+static inline uint8_t ror(fast_cpu_t *c, uint8_t v) {
+    bool carry = c->P & M6502_CF;
+    c->P = (c->P & ~M6502_CF) | ((v & 0x01) ? M6502_CF : 0);
+    v = (v >> 1) | (carry ? 0x80 : 0);
+    NZ(v);
+    return v;
+}
+
+static inline void bit(fast_cpu_t *c, uint8_t v) {
+    c->P = (c->P & ~M6502_VF) | (v & M6502_VF);
+    set_nz(c, v & M6502_NF, !(c->A & v));
+}
+
+// ---- Interpreter ----
+
+// Execute a decoded instruction at c->PC.  The caller has checked the code
+// page(s); everything else is checked here before any state changes.
+static inline int exec_decoded(N8Machine &m, fast_cpu_t *c, uint8_t op, uint8_t b1, uint16_t w) {
+    const uint8_t *mem = m.mem;
+    const uint16_t pc = c->PC;
+    const fast_op_t &info = fast_ops[op];
+    int cycles = info.cycles;
+    uint16_t ea = 0;        // effective address
+    uint16_t next = pc + 1; // address of the following instruction
+
+    // Pass 1: addressing mode; decline if any touched page needs the bus
+    switch (info.mode) {
+        case AM_IMP:
+            break;
+        case AM_IMM:
+            ea = pc + 1; next = pc + 2;
+            break;
+        case AM_ZP:
+            ea = b1; next = pc + 2;
+            if (!page_ok(m, 0)) return 0;
+            break;
+        case AM_ZPX:
+            ea = (uint8_t)(b1 + c->X); next = pc + 2;
+            if (!page_ok(m, 0)) return 0;
+            break;
+        case AM_ZPY:
+            ea = (uint8_t)(b1 + c->Y); next = pc + 2;
+            if (!page_ok(m, 0)) return 0;
+            break;
+        case AM_ABS:
+            ea = w; next = pc + 3;
+            // JMP/JSR only transfer control; the target fetch goes over the bus
+            if (op != 0x4C && op != 0x20 && !page_ok(m, ea)) return 0;
+            break;
+        case AM_ABX:
+        case AM_ABY: {
+            const uint8_t idx = (info.mode == AM_ABX) ? c->X : c->Y;
+            ea = w + idx; next = pc + 3;
+            // Indexed accesses also hit the un-carried address first
+            if (!page_ok(m, ea) || !page_ok(m, (w & 0xFF00) | (ea & 0x00FF))) return 0;
+            if (info.penalty && ((w ^ ea) & 0xFF00)) cycles++;
+            break;
+        }
+        case AM_IZX: {
+            const uint8_t zp = b1 + c->X;
+            ea = mem[zp] | (mem[(uint8_t)(zp + 1)] << 8); next = pc + 2;
+            if (!page_ok(m, 0) || !page_ok(m, ea)) return 0;
+            break;
+        }
+        case AM_IZY: {
+            const uint16_t base = mem[b1] | (mem[(uint8_t)(b1 + 1)] << 8);
+            ea = base + c->Y; next = pc + 2;
+            if (!page_ok(m, 0) || !page_ok(m, ea) || !page_ok(m, (base & 0xFF00) | (ea & 0x00FF))) return 0;
+            if (info.penalty && ((base ^ ea) & 0xFF00)) cycles++;
+            break;
+        }
+        case AM_IND:
+            // JMP ($xxFF) wraps within the page, like the real chip
+            if (!page_ok(m, w)) return 0;
+            ea = mem[w] | (mem[(w & 0xFF00) | ((w + 1) & 0x00FF)] << 8);
+            next = pc + 3;
+            break;
+        case AM_REL:
+            next = pc + 2;
+            break;
+    }
+    // Stack users
+    switch (op) {
+        case 0x08: case 0x48: case 0x68: case 0x20: case 0x60:
+            if (!page_ok(m, 0x0100)) return 0;
+            break;
+    }
+
+    // Pass 2: execute
+    uint8_t v;
+    c->PC = next;
+    switch (op) {
+        // Loads / stores
+        case 0xA9: case 0xA5: case 0xB5: case 0xAD: case 0xBD: case 0xB9: case 0xA1: case 0xB1:
+            c->A = mem[ea]; NZ(c->A); break;
+        case 0xA2: case 0xA6: case 0xB6: case 0xAE: case 0xBE:
+            c->X = mem[ea]; NZ(c->X); break;
+        case 0xA0: case 0xA4: case 0xB4: case 0xAC: case 0xBC:
+            c->Y = mem[ea]; NZ(c->Y); break;
+        case 0x85: case 0x95: case 0x8D: case 0x9D: case 0x99: case 0x81: case 0x91:
+            wr(m, ea, c->A); break;
+        case 0x86: case 0x96: case 0x8E:
+            wr(m, ea, c->X); break;
+        case 0x84: case 0x94: case 0x8C:
+            wr(m, ea, c->Y); break;
+
+        // ALU
+        case 0x09: case 0x05: case 0x15: case 0x0D: case 0x1D: case 0x19: case 0x01: case 0x11:
+            c->A |= mem[ea]; NZ(c->A); break;
+        case 0x29: case 0x25: case 0x35: case 0x2D: case 0x3D: case 0x39: case 0x21: case 0x31:
+            c->A &= mem[ea]; NZ(c->A); break;
+        case 0x49: case 0x45: case 0x55: case 0x4D: case 0x5D: case 0x59: case 0x41: case 0x51:
+            c->A ^= mem[ea]; NZ(c->A); break;
+        case 0x69: case 0x65: case 0x75: case 0x6D: case 0x7D: case 0x79: case 0x61: case 0x71:
+            adc(c, mem[ea]); break;
+        case 0xE9: case 0xE5: case 0xF5: case 0xED: case 0xFD: case 0xF9: case 0xE1: case 0xF1:
+            sbc(c, mem[ea]); break;
+        case 0xC9: case 0xC5: case 0xD5: case 0xCD: case 0xDD: case 0xD9: case 0xC1: case 0xD1:
+            cmp(c, c->A, mem[ea]); break;
+        case 0xE0: case 0xE4: case 0xEC:
+            cmp(c, c->X, mem[ea]); break;
+        case 0xC0: case 0xC4: case 0xCC:
+            cmp(c, c->Y, mem[ea]); break;
+        case 0x24: case 0x2C:
+            bit(c, mem[ea]); break;
+
+        // Read-modify-write
+        case 0x0A: c->A = asl(c, c->A); break;
+        case 0x4A: c->A = lsr(c, c->A); break;
+        case 0x2A: c->A = rol(c, c->A); break;
+        case 0x6A: c->A = ror(c, c->A); break;
+        case 0x06: case 0x16: case 0x0E: case 0x1E: wr(m, ea, asl(c, mem[ea])); break;
+        case 0x46: case 0x56: case 0x4E: case 0x5E: wr(m, ea, lsr(c, mem[ea])); break;
+        case 0x26: case 0x36: case 0x2E: case 0x3E: wr(m, ea, rol(c, mem[ea])); break;
+        case 0x66: case 0x76: case 0x6E: case 0x7E: wr(m, ea, ror(c, mem[ea])); break;
+        case 0xE6: case 0xF6: case 0xEE: case 0xFE: v = mem[ea] + 1; NZ(v); wr(m, ea, v); break;
+        case 0xC6: case 0xD6: case 0xCE: case 0xDE: v = mem[ea] - 1; NZ(v); wr(m, ea, v); break;
+
+        // Register transfers / inc / dec
+        case 0xAA: c->X = c->A; NZ(c->X); break;
+        case 0xA8: c->Y = c->A; NZ(c->Y); break;
+        case 0x8A: c->A = c->X; NZ(c->A); break;
+        case 0x98: c->A = c->Y; NZ(c->A); break;
+        case 0xBA: c->X = c->S; NZ(c->X); break;
+        case 0x9A: c->S = c->X; break;
+        case 0xE8: c->X++; NZ(c->X); break;
+        case 0xC8: c->Y++; NZ(c->Y); break;
+        case 0xCA: c->X--; NZ(c->X); break;
+        case 0x88: c->Y--; NZ(c->Y); break;
+
+        // Flags (CLI/SEI are left to the tick core)
+        case 0x18: c->P &= ~M6502_CF; break;
+        case 0x38: c->P |= M6502_CF; break;
+        case 0xD8: c->P &= ~M6502_DF; break;
+        case 0xF8: c->P |= M6502_DF; break;
+        case 0xB8: c->P &= ~M6502_VF; break;
+        case 0xEA: break;
+
+        // Stack
+        case 0x48: push(m, c, c->A); break;
+        case 0x08: push(m, c, flags_p(c) | M6502_XF); break;
+        case 0x68: c->A = pull(m, c); NZ(c->A); break;
+
+        // Control flow
+        case 0x4C: case 0x6C:
+            c->PC = ea; break;
+        case 0x20:
+            push(m, c, (pc + 2) >> 8);
+            push(m, c, (pc + 2) & 0xFF);
+            c->PC = ea;
+            break;
+        case 0x60: {
+            uint16_t ret = pull(m, c);
+            ret |= pull(m, c) << 8;
+            c->PC = ret + 1;
+            break;
+        }
+
+        // Branches: +1 taken, +1 more if the target is on another page
+        case 0x10: case 0x30: case 0x50: case 0x70:
+        case 0x90: case 0xB0: case 0xD0: case 0xF0: {
+            bool set;
+            switch (op >> 6) {
+                case 0:  set = flag_n(c); break;
+                case 1:  set = (c->P & M6502_VF) != 0; break;
+                case 2:  set = (c->P & M6502_CF) != 0; break;
+                default: set = flag_z(c); break;
+            }
+            if (set == ((op & 0x20) != 0)) {
+                const uint16_t target = next + (int8_t)b1;
+                cycles += ((target ^ next) & 0xFF00) ? 2 : 1;
+                c->PC = target;
+            }
+            break;
+        }
+    }
+    return cycles;
+}
+
+int emu_fast6502_exec(m6502_t *cpu) {
+    N8Machine &m = *n8;
+    const uint16_t pc = cpu->PC;
+    if (!page_ok(m, pc) || !page_ok(m, pc + 2)) return 0;
+
+    const uint8_t op = m.mem[pc];
+    if (fast_ops[op].mode == AM_NONE) return 0;
+
+    fast_cpu_t f;
+    load_cpu(&f, cpu);
+    const int cycles = exec_decoded(m, &f, op, m.mem[(uint16_t)(pc + 1)],
+                                    m.mem[(uint16_t)(pc + 1)] | (m.mem[(uint16_t)(pc + 2)] << 8));
+    if (!cycles) return 0;
+    store_cpu(cpu, &f);
+    if (m.cov) emu_cov_exec(*m.cov, pc, op, f.PC);
+    return cycles;
+}
+
+// ---- Basic-block cache ----
+//
+// A block is a straight run of decoded instructions inside one page, ending
+// after the first control transfer, before the first instruction the fast
+// path does not handle, or at BB_MAX_INSNS.  Blocks are built on first use
+// for any RAM or ROM page and stay valid until a write lands in their page:
+// MEM_TOUCH() calls emu_fast6502_invalidate() for pages flagged in
+// n8->bb_code_pages, which covers CPU stores (either path), self-modifying
+// code, debugger writes and ROM loads alike.
+
+#define BB_MAX_INSNS    32
+#define BB_CHAIN_CYCLES 1024    // max cycles per call before the bus gets a look in
+#define BB_SMC_LIMIT    16      // invalidations before a page is left uncached
+
+typedef struct {
+    uint8_t  op, b1;
+    uint16_t w;
+} bb_insn_t;
+
+typedef struct {
+    uint8_t   count;
+    uint16_t  worst;            // upper bound on cycles, for budget checks
+    bb_insn_t insn[BB_MAX_INSNS];
+} bb_block_t;
+
+static bb_block_t bb_none;                         // "no block here" marker
+
+// Per machine (N8Machine::bb), allocated when fast mode first runs; the
+// pages with entries are flagged in N8Machine::bb_code_pages
+struct emu_bb_cache_t {
+    bb_block_t *map[256][256];                     // [page][offset]
+    uint8_t smc_count[256];                        // invalidations per page
+    uint32_t gen;                                  // bumped by every invalidation
+};
+
+static const uint8_t mode_len[] = {
+    0, 1, 2, 2, 2, 2, 3, 3, 3, 2, 2, 3, 2   // indexed by fast_mode_t
+};
+
+static bool ends_block(uint8_t op) {
+    switch (op) {
+        case 0x4C: case 0x6C: case 0x20: case 0x60:                 // JMP, JSR, RTS
+        case 0x10: case 0x30: case 0x50: case 0x70:                 // branches
+        case 0x90: case 0xB0: case 0xD0: case 0xF0:
+            return true;
+    }
+    return false;
+}
+
+static bb_block_t *bb_build(N8Machine &m, uint16_t start) {
+    m.bb_code_pages[start >> 8] = 1;
+    bb_block_t *b = new bb_block_t;
+    b->count = 0;
+    b->worst = 0;
+    uint16_t pc = start;
+    while (b->count < BB_MAX_INSNS) {
+        const uint8_t op = m.mem[pc];
+        const fast_op_t &info = fast_ops[op];
+        if (info.mode == AM_NONE) break;
+        const int len = mode_len[info.mode];
+        if (((pc + len - 1) & 0xFF00) != (start & 0xFF00)) break;
+
+        bb_insn_t &in = b->insn[b->count++];
+        in.op = op;
+        in.b1 = m.mem[(uint16_t)(pc + 1)];
+        in.w  = in.b1 | (m.mem[(uint16_t)(pc + 2)] << 8);
+        b->worst += info.cycles + 2;    // +2 covers page-cross and branch penalties
+        pc += len;
+        if (ends_block(op)) break;
+    }
+    if (b->count == 0) {
+        delete b;
+        return &bb_none;
+    }
+    return b;
+}
+
+int emu_fast6502_block(m6502_t *cpu, uint64_t budget) {
+    N8Machine &m = *n8;
+    if (budget > BB_CHAIN_CYCLES) budget = BB_CHAIN_CYCLES;
+    if (!m.bb) m.bb = new emu_bb_cache_t();
+    emu_bb_cache_t &bb = *m.bb;
+
+    fast_cpu_t f;
+    load_cpu(&f, cpu);
+    int total = 0;
+    bool stop = false;
+    emu_cov_t *cov = m.cov;
+
+    // Chain straight from one block into the next.  Nothing a block can do
+    // unmasks or raises an interrupt (CLI/PLP/RTI and device pages are
+    // declined), so the bus only needs to run once at the end.
+    while (!stop) {
+        const uint16_t pc = f.PC;
+        const uint8_t page = pc >> 8;
+        if (!page_ok(m, pc) || bb.smc_count[page] >= BB_SMC_LIMIT) break;
+
+        bb_block_t *&slot = bb.map[page][pc & 0xFF];
+        if (!slot) slot = bb_build(m, pc);
+        const bb_block_t *b = slot;
+        if (b == &bb_none || b->worst > budget - total) break;
+
+        const uint32_t gen = bb.gen;
+        for (int i = 0; ; ) {
+            const bb_insn_t &in = b->insn[i];
+            const uint16_t at = f.PC;
+            const uint8_t op = in.op;           // in goes with b if this store hits cached code
+            const int n = exec_decoded(m, &f, op, in.b1, in.w);
+            if (!n) { stop = true; break; }     // data access needs the bus
+            if (cov) emu_cov_exec(*cov, at, op, f.PC);
+            total += n;
+            if (bb.gen != gen) { stop = true; break; }  // wrote over cached code: b may be gone
+            if (++i == b->count) break;
+        }
+    }
+    if (total) store_cpu(cpu, &f);
+    return total;
+}
+
+void emu_fast6502_invalidate(uint8_t page) {
+    N8Machine &m = *n8;
+    if (!m.bb_code_pages[page]) return;
+    emu_bb_cache_t &bb = *m.bb;
+    for (int i = 0; i < 256; i++) {
+        if (bb.map[page][i] != &bb_none) delete bb.map[page][i];
+        bb.map[page][i] = nullptr;
+    }
+    m.bb_code_pages[page] = 0;
+    if (bb.smc_count[page] < BB_SMC_LIMIT) bb.smc_count[page]++;
+    bb.gen++;
+}
+
+// Also releases the cache itself, so a dropped machine leaves nothing behind
+void emu_fast6502_flush() {
+    N8Machine &m = *n8;
+    if (!m.bb) return;
+    for (int page = 0; page < 256; page++) emu_fast6502_invalidate(page);
+    delete m.bb;
+    m.bb = nullptr;
+}
+
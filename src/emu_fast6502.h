@@ -0,0 +1,28 @@
+#pragma once
+
+// Instruction-at-a-time 6502 interpreter.  Executes a whole documented
+// opcode directly against mem[] and returns the cycles the cycle-stepped
+// core would have taken, so tick_count stays exact.
+//
+// Only handles what it can do without a bus: code, operands, stack and
+// data on plain RAM/ROM pages with no armed debug flags.  Device pages,
+// undocumented opcodes and the instructions that change the interrupt
+// mask (BRK, CLI, SEI, PLP, RTI) are declined and left to m6502_tick.
+
+#include "m6502.h"
+
+// cpu must be at an instruction boundary (PC = opcode address).  Returns
+// the cycle count (2-7) including the final opcode fetch of the next
+// instruction, or 0 with nothing changed if the instruction was declined.
+int emu_fast6502_exec(m6502_t *cpu);
+
+// Run predecoded basic blocks starting at cpu->PC, chaining from block to
+// block until one is missing, would exceed budget, or an instruction needs
+// the bus.  Returns the cycles executed (0: nothing run).  Interrupts are
+// only sampled between calls.
+int emu_fast6502_block(m6502_t *cpu, uint64_t budget);
+
+// Drop cached blocks for a page whose bytes changed (MEM_TOUCH does this
+// for every write) / for everything
+void emu_fast6502_invalidate(uint8_t page);
+void emu_fast6502_flush();
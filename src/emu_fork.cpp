@@ -0,0 +1,170 @@
+// Fork fan-out, see emu_fork.h.
+//
+// Per child: stdout (where tty_decode() writes) goes to one pipe, a
+// fixed-size summary to a second.  The parent polls all running children,
+// so a chatty child never blocks on a full pipe, and reaps each one once
+// both pipes reach EOF.
+
+#include "emu_fork.h"
+#include "emu_tty.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct fork_summary_t {
+    uint64_t cycles;
+    int32_t  reason;
+};
+
+struct fork_child_t {
+    size_t index;       // into inputs/results
+    pid_t  pid;
+    int    out_fd;      // TTY output, -1 once at EOF
+    int    sum_fd;      // summary, -1 once at EOF
+    fork_summary_t sum;
+    size_t sum_len;
+};
+
+static void write_all(int fd, const void *buf, size_t len) {
+    const char *p = (const char *)buf;
+    while (len) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        p += n;
+        len -= n;
+    }
+}
+
+// Child side: never returns
+static void fork_child(const std::string &input, uint64_t max_cycles, int out_fd, int sum_fd) {
+    dup2(out_fd, STDOUT_FILENO);
+    close(out_fd);
+
+    // Host input typed before the fork would land ahead of (or among) the
+    // variant's own and make its result depend on timing
+    tty_drop_host_input();
+    for (size_t i = 0; i < input.size(); i++) tty_inject_char((uint8_t)input[i]);
+    emulator_clear_bp_hit();
+    emulator_clear_wp_hit();
+
+    fork_summary_t sum;
+    emu_stop_reason_t reason;
+    sum.cycles = emulator_run(max_cycles, &reason);
+    sum.reason = reason;
+    fflush(stdout);
+    write_all(sum_fd, &sum, sizeof(sum));
+    _exit(0);   // no atexit handlers: the terminal belongs to the parent
+}
+
+static bool fork_start(const std::string &input, uint64_t max_cycles, fork_child_t &c) {
+    int out[2], sum[2];
+    if (pipe(out) != 0) return false;
+    if (pipe(sum) != 0) {
+        close(out[0]); close(out[1]);
+        return false;
+    }
+    fflush(stdout);     // don't hand buffered output to the child
+    fflush(stderr);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(out[0]); close(out[1]); close(sum[0]); close(sum[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(out[0]);
+        close(sum[0]);
+        fork_child(input, max_cycles, out[1], sum[1]);
+    }
+    close(out[1]);
+    close(sum[1]);
+    c.pid = pid;
+    c.out_fd = out[0];
+    c.sum_fd = sum[0];
+    c.sum_len = 0;
+    memset(&c.sum, 0, sizeof(c.sum));
+    return true;
+}
+
+// Read what is available; closes the fd at EOF
+static void fork_drain(fork_child_t &c, bool summary, std::string &output) {
+    int &fd = summary ? c.sum_fd : c.out_fd;
+    char buf[4096];
+    ssize_t n;
+    if (summary) {
+        n = read(fd, (char *)&c.sum + c.sum_len, sizeof(c.sum) - c.sum_len);
+        if (n > 0) c.sum_len += n;
+    } else {
+        n = read(fd, buf, sizeof(buf));
+        if (n > 0) output.append(buf, n);
+    }
+    if (n == 0 || (n < 0 && errno != EINTR && errno != EAGAIN) ||
+        (summary && c.sum_len == sizeof(c.sum))) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool emu_fork_run(const std::vector<std::string> &inputs, uint64_t max_cycles, int jobs,
+                  std::vector<emu_fork_result_t> &results) {
+    results.clear();
+    if (max_cycles == 0) return false;
+    if (jobs <= 0) jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs <= 0) jobs = 1;
+
+    results.assign(inputs.size(), emu_fork_result_t());
+    std::vector<fork_child_t> running;
+    size_t next = 0;
+    bool ok = true;
+
+    while (next < inputs.size() || !running.empty()) {
+        while (ok && next < inputs.size() && (int)running.size() < jobs) {
+            fork_child_t c;
+            c.index = next;
+            results[next].input = inputs[next];
+            results[next].reason = EMU_STOP_CYCLES;
+            results[next].cycles = 0;
+            results[next].status = -1;
+            if (!fork_start(inputs[next], max_cycles, c)) {
+                ok = false;
+                break;
+            }
+            running.push_back(c);
+            next++;
+        }
+        if (!ok && running.empty()) break;
+
+        std::vector<pollfd> fds;
+        for (auto &c : running) {
+            if (c.out_fd >= 0) fds.push_back({c.out_fd, POLLIN, 0});
+            if (c.sum_fd >= 0) fds.push_back({c.sum_fd, POLLIN, 0});
+        }
+        if (!fds.empty() && poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) {
+            ok = false;
+        }
+        for (const pollfd &p : fds) {
+            if (!(p.revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            for (auto &c : running) {
+                if (p.fd == c.out_fd) fork_drain(c, false, results[c.index].output);
+                else if (p.fd == c.sum_fd) fork_drain(c, true, results[c.index].output);
+            }
+        }
+
+        for (size_t i = 0; i < running.size(); ) {
+            fork_child_t &c = running[i];
+            if (c.out_fd >= 0 || c.sum_fd >= 0) { i++; continue; }
+            emu_fork_result_t &r = results[c.index];
+            while (waitpid(c.pid, &r.status, 0) < 0 && errno == EINTR) {}
+            if (c.sum_len == sizeof(c.sum)) {
+                r.cycles = c.sum.cycles;
+                r.reason = (emu_stop_reason_t)c.sum.reason;
+            }
+            running.erase(running.begin() + i);
+        }
+    }
+    return ok;
+}
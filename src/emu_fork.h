@@ -0,0 +1,31 @@
+#pragma once
+
+// Fork fan-out: boot once, then run many what-if variants in parallel.
+// Each child process starts from a copy-on-write image of the booted
+// machine, feeds its input into the TTY and runs on its own; the parent
+// collects TTY output, stop reason and cycle count over pipes.  POSIX only.
+
+#include "emulator.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct emu_fork_result_t {
+    std::string       input;
+    std::string       output;       // everything the child wrote to the TTY
+    emu_stop_reason_t reason;
+    uint64_t          cycles;       // run by the child (after the fork)
+    int               status;       // waitpid() status; 0 = clean exit
+};
+
+// One child per input, at most jobs at a time (0: one per online CPU).
+// Children drop any host input still on its way to the TTY (it would
+// mix with theirs), inject their input with tty_inject_char() and call
+// emulator_run(max_cycles), so breakpoints, fast mode and idle skipping
+// behave as set up in the parent.  results[i] belongs to inputs[i].
+// Returns false if a pipe or fork failed; children already started are
+// still collected.  max_cycles 0 is refused (false, no children): for
+// emulator_run() it means zero cycles, not "until a breakpoint".
+bool emu_fork_run(const std::vector<std::string> &inputs, uint64_t max_cycles, int jobs,
+                  std::vector<emu_fork_result_t> &results);
@@ -0,0 +1,17 @@
+// Memory access heatmap counters, see emu_heat.h.
+
+#include "emu_heat.h"
+#include "n8_machine.h"
+
+void emu_heat_enable(bool en) {
+    delete n8->heat;
+    n8->heat = en ? new emu_heat_t() : nullptr;
+}
+
+bool emu_heat_enabled() {
+    return n8->heat != nullptr;
+}
+
+const emu_heat_t *emu_heat_counts() {
+    return n8->heat;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Memory access heatmap counters: bus reads, writes and opcode fetches
+// per address, one array each so a bus cycle touches a single counter.
+// Counters are 32 bits and wrap rather than saturate, so readers look at
+// differences between two copies.
+//
+// The three arrays take 768 KB, allocated on enable and freed on disable;
+// enabling again is the only reset.  Cycles re-run by a rewind aren't
+// counted twice, and seeking back doesn't take any counts away.
+// Counting costs an increment per bus cycle, and fast mode falls back to
+// the tick core while it is on.  Skipped idle-loop passes aren't counted.
+// Acts on the calling thread's machine (N8Machine::heat).
+
+#include <stdint.h>
+
+struct emu_heat_t {
+    uint32_t r[1 << 16];    // data/operand reads
+    uint32_t w[1 << 16];
+    uint32_t x[1 << 16];    // opcode fetches
+};
+
+void emu_heat_enable(bool en);      // starts from zero
+bool emu_heat_enabled();
+const emu_heat_t *emu_heat_counts();    // nullptr while off
+
+// Bus path, once per cycle after the access
+static inline void emu_heat_count(emu_heat_t &h, uint16_t addr, bool read, bool sync) {
+    uint32_t *c = sync ? h.x : read ? h.r : h.w;
+    c[addr]++;
+}
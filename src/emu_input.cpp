@@ -0,0 +1,315 @@
+// Input log record/replay, see emu_input.h.
+//
+// Replay splits the log in two streams by when an event takes effect:
+// TTY/KEY bytes inside a cycle, from the EMU_EV_INPUT event, and the rest
+// before a cycle, from emu_input_run().  Each stream has its own cursor;
+// the replay is over when both reach the end.
+
+#include "emu_input.h"
+#include "emu_rewind.h"
+#include "emu_sched.h"
+#include "emu_tty.h"
+#include "gui_console.h"
+#include "m6502.h"
+#include "n8_machine.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#define EMU_INPUT_HEADER 16     // magic, version, pad, start tick
+
+struct emu_input_ev_t {
+    uint64_t tick;
+    uint8_t  type;
+    uint16_t addr;
+    uint16_t val;
+};
+
+struct emu_input_t {
+    FILE    *rec = nullptr;         // recording to
+    uint64_t rec_tick = 0;          // tick of the last record written
+    std::vector<emu_input_ev_t> log;    // replaying
+    size_t   next_byte = 0;         // next TTY/KEY entry in log
+    size_t   next_other = 0;        // next RESET/MEM/REG/END entry in log
+    bool     replay = false;
+    uint64_t events = 0;
+};
+
+static bool input_is_byte(uint8_t type) {
+    return type == EMU_IN_TTY || type == EMU_IN_KEY;
+}
+
+// First entry at or after i in the same stream as bytes says
+static size_t input_next(const emu_input_t &in, size_t i, bool bytes) {
+    while (i < in.log.size() && input_is_byte(in.log[i].type) != bytes) i++;
+    return i;
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static void input_write(emu_input_t &in, uint64_t now, uint8_t type, uint16_t addr, uint16_t val) {
+    uint8_t buf[16];
+    size_t n = 0;
+    uint64_t delta = now - in.rec_tick;
+    do {
+        buf[n] = delta & 0x7F;
+        delta >>= 7;
+        if (delta) buf[n] |= 0x80;
+        n++;
+    } while (delta);
+    buf[n++] = type;
+    switch (type) {
+        case EMU_IN_MEM:
+            buf[n++] = addr & 0xFF;
+            buf[n++] = addr >> 8;
+            buf[n++] = (uint8_t)val;
+            break;
+        case EMU_IN_REG:
+            buf[n++] = (uint8_t)addr;
+            buf[n++] = val & 0xFF;
+            buf[n++] = val >> 8;
+            break;
+        default:
+            buf[n++] = (uint8_t)val;
+            break;
+    }
+    // Flushed per record: a log is most wanted when the process dies
+    fwrite(buf, 1, n, in.rec);
+    fflush(in.rec);
+    in.rec_tick = now;
+    if (type != EMU_IN_END) in.events++;
+}
+
+static bool input_parse(const std::vector<uint8_t> &data, uint64_t &start,
+                        std::vector<emu_input_ev_t> &log) {
+    if (data.size() < EMU_INPUT_HEADER || memcmp(data.data(), "N8IN", 4) != 0 ||
+        data[4] != EMU_INPUT_VERSION) {
+        return false;
+    }
+    start = get_u64(&data[8]);
+    uint64_t tick = start;
+    size_t p = EMU_INPUT_HEADER;
+    while (p < data.size()) {
+        uint64_t delta = 0;
+        int shift = 0;
+        uint8_t b;
+        do {
+            if (p >= data.size() || shift > 63) return false;
+            b = data[p++];
+            delta |= (uint64_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        if (p >= data.size()) return false;
+        emu_input_ev_t ev = { tick += delta, data[p++], 0, 0 };
+        const size_t need = ev.type == EMU_IN_MEM || ev.type == EMU_IN_REG ? 3 : 1;
+        if (ev.type < EMU_IN_TTY || ev.type > EMU_IN_END || data.size() - p < need) return false;
+        switch (ev.type) {
+            case EMU_IN_MEM:
+                ev.addr = data[p] | (data[p + 1] << 8);
+                ev.val = data[p + 2];
+                break;
+            case EMU_IN_REG:
+                ev.addr = data[p];
+                ev.val = data[p + 1] | (data[p + 2] << 8);
+                break;
+            default:
+                ev.val = data[p];
+                break;
+        }
+        p += need;
+        log.push_back(ev);
+    }
+    return true;
+}
+
+static void input_done(emu_input_t &in) {
+    if (in.next_byte < in.log.size() || in.next_other < in.log.size()) return;
+    in.replay = false;
+    emu_sched_cancel(EMU_EV_INPUT);
+    tty_hold_input(TTY_HOLD_INPUT, false);
+}
+
+static void input_byte_event(uint64_t now);
+
+static void input_book(emu_input_t &in, uint64_t now) {
+    if (in.next_byte < in.log.size()) {
+        emu_sched_at(EMU_EV_INPUT, std::max(now, in.log[in.next_byte].tick), input_byte_event);
+    } else {
+        emu_sched_cancel(EMU_EV_INPUT);
+        input_done(in);
+    }
+}
+
+static void input_byte_event(uint64_t now) {
+    emu_input_t &in = *n8->input;
+    const emu_input_ev_t ev = in.log[in.next_byte];
+    in.next_byte = input_next(in, in.next_byte + 1, true);
+    in.events++;
+    emu_input_apply((emu_input_type_t)ev.type, ev.addr, ev.val);
+    input_book(in, now);
+}
+
+bool emu_input_record(const char *path) {
+    if (n8->input) return false;
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    uint8_t hdr[EMU_INPUT_HEADER] = { 'N', '8', 'I', 'N', EMU_INPUT_VERSION };
+    put_u64(&hdr[8], n8->tick_count);
+    if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || fflush(f) != 0) {
+        fclose(f);
+        return false;
+    }
+    n8->input = new emu_input_t();
+    n8->input->rec = f;
+    n8->input->rec_tick = n8->tick_count;
+    return true;
+}
+
+bool emu_input_replay(const char *path) {
+    char msg[256];
+    if (n8->input) return false;
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        snprintf(msg, sizeof(msg), "[input] can't open %s\n", path);
+        gui_con_printmsg(msg);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    uint64_t start = 0;
+    std::vector<emu_input_ev_t> log;
+    if (!input_parse(data, start, log)) {
+        snprintf(msg, sizeof(msg), "[input] %s: not an input log or truncated\n", path);
+        gui_con_printmsg(msg);
+        return false;
+    }
+    if (start != n8->tick_count) {
+        snprintf(msg, sizeof(msg), "[input] %s starts at tick %llu, machine is at %llu\n", path,
+                 (unsigned long long)start, (unsigned long long)n8->tick_count);
+        gui_con_printmsg(msg);
+        return false;
+    }
+
+    emu_input_t &in = *(n8->input = new emu_input_t());
+    in.log.swap(log);
+    in.next_byte = input_next(in, 0, true);
+    in.next_other = input_next(in, 0, false);
+    in.replay = true;
+    tty_hold_input(TTY_HOLD_INPUT, true);
+    input_book(in, n8->tick_count);
+    return true;
+}
+
+void emu_input_stop() {
+    emu_input_t *in = n8->input;
+    if (!in) return;
+    if (in->rec) {
+        input_write(*in, n8->tick_count, EMU_IN_END, 0, 0);
+        fclose(in->rec);
+    }
+    if (in->replay) {
+        emu_sched_cancel(EMU_EV_INPUT);
+        tty_hold_input(TTY_HOLD_INPUT, false);
+    }
+    delete in;
+    n8->input = nullptr;
+}
+
+bool emu_input_recording() {
+    return n8->input && n8->input->rec;
+}
+
+bool emu_input_replaying() {
+    return n8->input && n8->input->replay;
+}
+
+uint64_t emu_input_events() {
+    return n8->input ? n8->input->events : 0;
+}
+
+void emu_input_note(emu_input_type_t type, uint16_t addr, uint16_t val) {
+    emu_input_t *in = n8->input;
+    if (in && in->rec) input_write(*in, n8->tick_count, type, addr, val);
+    if (type == EMU_IN_TTY) {
+        emu_rewind_input(n8->tick_count, (uint8_t)val);
+    } else {
+        emu_rewind_mark();
+    }
+}
+
+void emu_input_apply(emu_input_type_t type, uint16_t addr, uint16_t val) {
+    switch (type) {
+        case EMU_IN_TTY:
+            tty_inject_char((uint8_t)val);
+            break;
+        case EMU_IN_KEY:
+            break;
+        case EMU_IN_END:
+            return;
+        case EMU_IN_RESET:
+            if (val == EMU_IN_RESET_CPU) {
+                n8->pins |= M6502_RES;
+                tty_reset();
+            } else {
+                emulator_reset_machine();
+            }
+            break;
+        case EMU_IN_MEM:
+            emulator_write_mem(addr, (uint8_t)val);
+            break;
+        case EMU_IN_REG:
+            switch (addr) {
+                case 0: emulator_write_a((uint8_t)val); break;
+                case 1: emulator_write_x((uint8_t)val); break;
+                case 2: emulator_write_y((uint8_t)val); break;
+                case 3: emulator_write_s((uint8_t)val); break;
+                case 4: emulator_write_p((uint8_t)val); break;
+                case 5: emulator_write_pc(val); break;
+            }
+            break;
+    }
+    emu_input_note(type, addr, val);
+}
+
+uint64_t emu_input_run(uint64_t max_cycles, emu_stop_reason_t *stop_reason) {
+    emu_input_t *in = n8->input;
+    if (!in || !in->replay) return emulator_run(max_cycles, stop_reason);
+
+    const uint64_t end = n8->tick_count + max_cycles;
+    emu_stop_reason_t reason = EMU_STOP_CYCLES;
+    uint64_t ran = 0;
+    for (;;) {
+        // Events logged at this tick happened before its cycle
+        while (in->replay && in->next_other < in->log.size() &&
+               in->log[in->next_other].tick <= n8->tick_count) {
+            const emu_input_ev_t ev = in->log[in->next_other];
+            in->next_other = input_next(*in, in->next_other + 1, false);
+            if (ev.type != EMU_IN_END) in->events++;
+            emu_input_apply((emu_input_type_t)ev.type, ev.addr, ev.val);
+            input_done(*in);
+        }
+        if (n8->tick_count >= end) break;
+        uint64_t stop = end;
+        if (in->replay && in->next_other < in->log.size()) {
+            stop = std::min(stop, in->log[in->next_other].tick);
+        }
+        ran += emulator_run(stop - n8->tick_count, &reason);
+        if (reason != EMU_STOP_CYCLES) break;
+    }
+    if (stop_reason) *stop_reason = reason;
+    return ran;
+}
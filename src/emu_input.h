@@ -0,0 +1,72 @@
+#pragma once
+
+// Input log: every event that reaches a machine from outside the CPU
+// (host TTY byte, reset, debugger memory/register write), stamped with the
+// cycle it took effect at.  The core is deterministic given its input, so
+// replaying the log from the state the recording started at repeats the
+// run bit-exactly, at whatever speed the host manages.
+//
+// Whoever changes the machine from outside calls emu_input_note() right
+// after, between emulator_run()/emulator_step() calls; TTY bytes are noted
+// by the UART event itself.  A note also keeps the reverse execution
+// history (emu_rewind.h) in step.
+//
+// File format, little endian:
+//
+//     "N8IN" version:u8 0:u8[3] start_tick:u64
+//     record*:  delta:uleb128 type:u8 payload
+//
+// delta is the tick since the previous record (the start tick for the
+// first).  Payload by type: TTY/KEY byte; RESET kind:u8; MEM addr:u16 v:u8;
+// REG reg:u8 v:u16; END 0:u8.  A log without END (process killed) just
+// ends at its last event.
+//
+// Replay feeds TTY bytes from a scheduled event at their cycle, with host
+// input held back until the end of the recording; the other events take
+// effect between cycles, so runs have to go through emu_input_run(), which
+// stops at each one.  Going back in time (emu_rewind) ends recording and
+// replay.
+// Everything acts on the calling thread's machine.
+
+#include "emulator.h"
+
+#include <stdint.h>
+
+#define EMU_INPUT_VERSION 1
+
+struct emu_input_t;     // N8Machine::input
+
+typedef enum {
+    EMU_IN_TTY   = 1,   // val: byte into the TTY input FIFO
+    EMU_IN_KEY   = 2,   // val: keyboard scancode (no keyboard device yet)
+    EMU_IN_RESET = 3,   // val: EMU_IN_RESET_*
+    EMU_IN_MEM   = 4,   // addr, val: byte written by the debugger
+    EMU_IN_REG   = 5,   // addr: register (0-4 A X Y S P, 5 PC), val
+    EMU_IN_END   = 6    // recording stopped here (written by emu_input_stop())
+} emu_input_type_t;
+
+typedef enum {
+    EMU_IN_RESET_MACHINE = 0,   // emulator_reset_machine(): CPU, TTY, ROM reload
+    EMU_IN_RESET_CPU     = 1    // RES pin and TTY only (GDB monitor reset)
+} emu_input_reset_t;
+
+// Start logging to path from the current state.  false if it can't be
+// written or a replay is running.
+bool emu_input_record(const char *path);
+// Load path and replay it.  The machine must be at the recording's start
+// tick, in the state it was recorded from (same ROM, same boot).
+bool emu_input_replay(const char *path);
+void emu_input_stop();              // close the log / abandon the replay
+bool emu_input_recording();
+bool emu_input_replaying();         // until the last event has been fed
+uint64_t emu_input_events();        // recorded so far / replayed so far
+
+// An outside event has just been applied at tick_count
+void emu_input_note(emu_input_type_t type, uint16_t addr = 0, uint16_t val = 0);
+
+// Apply a replayed event as the original source did (and note it)
+void emu_input_apply(emu_input_type_t type, uint16_t addr, uint16_t val);
+
+// emulator_run() that applies replayed events at their cycles; same
+// contract, stops early only for breakpoints and watchpoints
+uint64_t emu_input_run(uint64_t max_cycles, emu_stop_reason_t *stop_reason);
@@ -0,0 +1,46 @@
+// IRQ controller, see emu_irq.h.
+
+#include "emu_irq.h"
+#include "emu_bus.h"
+#include "m6502.h"
+#include "n8_machine.h"
+
+// The backing byte mirrors the register so memory views, snapshots and
+// GDB reads of $D800 show the live value
+static void irq_update(N8Machine &m, uint8_t flags) {
+    const bool was = m.irq_flags != 0;
+    m.irq_flags = flags;
+    m.mem[N8_IRQ_FLAGS] = flags;
+    MEM_TOUCH(m, N8_IRQ_FLAGS);
+    if ((flags != 0) != was) {
+        if (flags) m.pins |= M6502_IRQ;
+        else       m.pins &= ~M6502_IRQ;
+    }
+}
+
+void emu_set_irq(int bit) {
+    const uint8_t flags = n8->irq_flags | (0x01 << bit);
+    if (flags != n8->irq_flags) irq_update(*n8, flags);
+}
+
+void emu_clr_irq(int bit) {
+    const uint8_t flags = n8->irq_flags & ~(0x01 << bit);
+    if (flags != n8->irq_flags) irq_update(*n8, flags);
+}
+
+void emu_irq_reset() {
+    n8->irq_flags = 0;
+    n8->mem[N8_IRQ_FLAGS] = 0;
+    MEM_TOUCH(*n8, N8_IRQ_FLAGS);
+    n8->pins &= ~M6502_IRQ;
+}
+
+uint8_t emu_irq_flags() {
+    return n8->irq_flags;
+}
+
+void emu_irq_dev(uint64_t &pins, uint8_t reg) {
+    if (pins & M6502_RW) {
+        M6502_SET_DATA(pins, reg == 0 ? n8->irq_flags : 0x00);
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// IRQ controller.  Each device owns one source bit (N8_IRQ_BIT_*) and
+// holds it high for as long as it wants service, calling in only when
+// that changes (emu_set_irq / emu_clr_irq in emulator.h).  The CPU's IRQ
+// pin follows the OR of all sources and is only written when that
+// aggregate changes.  Firmware reads the flags at N8_IRQ_FLAGS ($D800,
+// device slot 0); the register is read-only from the CPU side.
+
+#include <stdint.h>
+
+void    emu_irq_reset();        // all sources low, pin released
+uint8_t emu_irq_flags();
+
+// Slot handler for N8_IRQ_SLOT (mapped by emulator_bus_init)
+void emu_irq_dev(uint64_t &pins, uint8_t reg);
@@ -14,6 +14,9 @@
 std::list<std::string> labels[65536];
 
 const char *label_file = "N8firmware.sym";
+void emu_labels_set_file(const char *file) {
+    label_file = file;
+}
 void emu_labels_add(uint16_t addr, char * label) {
     labels[addr].remove(label);
     labels[addr].emplace_back(label);
@@ -22,6 +25,9 @@ void emu_labels_add(uint16_t addr, char * label) {
 std::list<std::string> emu_labels_get(uint16_t addr) {
     return labels[addr];
 }
+const char *emu_labels_name(uint16_t addr) {
+    return labels[addr].empty() ? nullptr : labels[addr].front().c_str();
+}
 void emu_labels_clear() {
     for(int i = 0; i < 65536; i++) {
         while(labels[i].size() > 0) {
@@ -42,6 +48,7 @@ void emu_labels_console_list() {
     }
 }
 void emu_labels_load() {
+    if(!label_file) return;  // symbols disabled (headless without -s)
     printf("Loading Symbols\r\n");fflush(stdout);
     FILE *fp = fopen(label_file, "r");
     if(!fp) {printf("ERROR label load\r\n"); fflush(stdout);exit(-1);}
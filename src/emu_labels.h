@@ -6,7 +6,9 @@
 #include <list>
 
 std::list<std::string> emu_labels_get(uint16_t addr);
+const char *emu_labels_name(uint16_t addr);   // first label at addr, nullptr if none
 void emu_labels_console_list();
 void emu_labels_load();
+void emu_labels_set_file(const char *file);
 void emu_labels_init();
 // emu_labels_get(uint);
@@ -0,0 +1,217 @@
+// Flat cycle profiler, see emu_prof.h.
+
+#include "emu_prof.h"
+#include "emu_labels.h"
+#include "n8_machine.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+void emu_prof_enable(bool en) {
+    if (!en) {
+        delete n8->prof;
+        n8->prof = nullptr;
+        return;
+    }
+    if (!n8->prof) n8->prof = new emu_prof_t();
+    emu_prof_clear();
+}
+
+bool emu_prof_enabled() {
+    return n8->prof != nullptr;
+}
+
+static uint32_t prof_edge(emu_prof_t &p, uint16_t caller, uint16_t site, uint16_t callee) {
+    const uint64_t key = (uint64_t)caller << 32 | (uint32_t)site << 16 | callee;
+    auto it = p.edge_index.find(key);
+    if (it != p.edge_index.end()) return it->second;
+    p.edges.push_back({caller, site, callee, 0, 0});
+    p.edge_index[key] = (uint32_t)(p.edges.size() - 1);
+    return (uint32_t)(p.edges.size() - 1);
+}
+
+// Calls in flight keep their frames; their edges start again from zero
+void emu_prof_clear() {
+    emu_prof_t *p = n8->prof;
+    if (!p) return;
+    memset(p->cycles, 0, sizeof(p->cycles));
+    memset(p->self, 0, sizeof(p->self));
+    std::vector<emu_prof_edge_t> open;
+    for (int i = 1; i < p->depth; i++) open.push_back(p->edges[p->frames[i].edge]);
+    p->edges.clear();
+    p->edge_index.clear();
+    if (p->depth == 0) {
+        p->frames[0] = { n8->cur_instruction, 0xFF, UINT32_MAX, 0 };
+        p->depth = 1;
+    }
+    for (int i = 1; i < p->depth; i++) {
+        p->frames[i].edge = prof_edge(*p, open[i - 1].caller, open[i - 1].site, open[i - 1].callee);
+        p->frames[i].enter = n8->tick_count;
+    }
+    emu_prof_resync();
+}
+
+const uint32_t *emu_prof_cycles() {
+    return n8->prof ? n8->prof->cycles : nullptr;
+}
+
+// After a jump in time, frames S is now above are dropped; the rest are
+// kept as they were
+void emu_prof_resync() {
+    emu_prof_t *p = n8->prof;
+    if (!p) return;
+    p->pc = n8->cur_instruction;
+    p->tick = n8->tick_count;
+    p->op = n8->mem[p->pc];
+    p->s = n8->cpu.S;
+    while (p->depth > 1 && p->s > p->frames[p->depth - 1].ret_s) p->depth--;
+}
+
+static void prof_pop(emu_prof_t &p, uint64_t now) {
+    const emu_prof_frame_t &f = p.frames[--p.depth];
+    emu_prof_edge_t &e = p.edges[f.edge];
+    e.calls++;
+    e.incl += now > f.enter ? now - f.enter : 0;
+}
+
+static inline uint16_t prof_vector(uint16_t addr) {
+    return n8->mem[addr] | n8->mem[addr + 1] << 8;
+}
+
+void emu_prof_stack(emu_prof_t &p, uint16_t pc, uint8_t s, uint64_t now) {
+    // BRK, interrupts and reset all end up at a vector, TSX/TXS games don't
+    const uint8_t drop = (uint8_t)(p.s - s);
+    if (drop == 3 && pc == prof_vector(0xFFFC)) {
+        while (p.depth > 1) prof_pop(p, now);
+        p.frames[0] = { pc, 0xFF, UINT32_MAX, now };
+        return;
+    }
+    if ((drop == 3 && (pc == prof_vector(0xFFFE) || pc == prof_vector(0xFFFA))) ||
+        (drop == 2 && p.op == 0x20)) {
+        // Past the shadow stack's depth calls go uncounted; their returns
+        // don't reach the frame below, which stays put
+        if (p.depth == EMU_PROF_DEPTH) return;
+        const uint16_t caller = p.frames[p.depth - 1].fn;
+        p.frames[p.depth++] = { pc, p.s, prof_edge(p, caller, p.pc, pc), now };
+        return;
+    }
+    const bool ret = p.op == 0x60 || p.op == 0x40;
+    while (p.depth > 1 && (s > p.frames[p.depth - 1].ret_s || (ret && s == p.frames[p.depth - 1].ret_s))) {
+        prof_pop(p, now);
+    }
+}
+
+void emu_prof_symbols(const uint32_t *cycles, std::vector<emu_prof_sym_t> &out) {
+    out.clear();
+    char name[8];
+    for (int addr = 0; addr < (1 << 16); addr++) {
+        const char *label = emu_labels_name((uint16_t)addr);
+        if (label || out.empty()) {
+            if (!label) {
+                snprintf(name, sizeof(name), "$%4.4X", addr);
+                label = name;
+            }
+            out.push_back({label, (uint16_t)addr, 0});
+        }
+        out.back().cycles += cycles[addr];
+    }
+    out.erase(std::remove_if(out.begin(), out.end(),
+                             [](const emu_prof_sym_t &s) { return s.cycles == 0; }),
+              out.end());
+    std::stable_sort(out.begin(), out.end(), [](const emu_prof_sym_t &a, const emu_prof_sym_t &b) {
+        return a.cycles > b.cycles;
+    });
+}
+
+bool emu_prof_save(const char *path, const uint32_t *cycles) {
+    std::vector<emu_prof_sym_t> syms;
+    emu_prof_symbols(cycles, syms);
+    uint64_t total = 0;
+    for (const emu_prof_sym_t &s : syms) total += s.cycles;
+
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "# %llu cycles\n# %14s %7s  %-5s  %s\n", (unsigned long long)total,
+            "cycles", "%", "addr", "symbol");
+    for (const emu_prof_sym_t &s : syms) {
+        fprintf(f, "%16llu %6.2f%%  $%4.4X  %s\n", (unsigned long long)s.cycles,
+                total ? 100.0 * s.cycles / total : 0.0, s.addr, s.name.c_str());
+    }
+    return fclose(f) == 0;
+}
+
+bool emu_prof_graph(emu_prof_graph_t &out) {
+    const emu_prof_t *p = n8->prof;
+    if (!p) return false;
+    out.self.clear();
+    out.total = 0;
+    for (int fn = 0; fn < (1 << 16); fn++) {
+        if (!p->self[fn]) continue;
+        out.self.push_back({(uint16_t)fn, p->self[fn]});
+        out.total += p->self[fn];
+    }
+    out.edges = p->edges;
+    for (int i = 1; i < p->depth; i++) {
+        emu_prof_edge_t &e = out.edges[p->frames[i].edge];
+        e.calls++;
+        e.incl += p->tick > p->frames[i].enter ? p->tick - p->frames[i].enter : 0;
+    }
+    return true;
+}
+
+// Label at the entry, else the nearest one below plus the offset
+static std::string prof_fn_name(uint16_t fn) {
+    char name[300];
+    for (int addr = fn; addr >= 0; addr--) {
+        const char *label = emu_labels_name((uint16_t)addr);
+        if (!label) continue;
+        if (addr == fn) return label;
+        snprintf(name, sizeof(name), "%s+%d", label, fn - addr);
+        return name;
+    }
+    snprintf(name, sizeof(name), "$%4.4X", fn);
+    return name;
+}
+
+bool emu_prof_callgrind(const char *path, const emu_prof_graph_t &graph) {
+    std::vector<emu_prof_edge_t> edges = graph.edges;
+    std::stable_sort(edges.begin(), edges.end(), [](const emu_prof_edge_t &a, const emu_prof_edge_t &b) {
+        return a.caller < b.caller;
+    });
+    std::vector<uint16_t> fns;
+    for (const auto &f : graph.self) fns.push_back(f.first);
+    for (const emu_prof_edge_t &e : edges) fns.push_back(e.caller);
+    std::sort(fns.begin(), fns.end());
+    fns.erase(std::unique(fns.begin(), fns.end()), fns.end());
+
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "# callgrind format\nversion: 1\ncreator: n8machine\npositions: instr\n"
+               "events: Cycles\nsummary: %llu\n", (unsigned long long)graph.total);
+
+    // Names are given once, then referred to by number (name compression)
+    std::unordered_map<uint16_t, int> ids;
+    auto ref = [&](uint16_t fn) {
+        auto it = ids.find(fn);
+        if (it != ids.end()) return "(" + std::to_string(it->second) + ")";
+        const int id = (int)ids.size() + 1;
+        ids[fn] = id;
+        return "(" + std::to_string(id) + ") " + prof_fn_name(fn);
+    };
+    size_t si = 0, ei = 0;
+    for (uint16_t fn : fns) {
+        fprintf(f, "\nfn=%s\n", ref(fn).c_str());
+        while (si < graph.self.size() && graph.self[si].first < fn) si++;
+        if (si < graph.self.size() && graph.self[si].first == fn) {
+            fprintf(f, "0x%4.4X %llu\n", fn, (unsigned long long)graph.self[si].second);
+        }
+        for (; ei < edges.size() && edges[ei].caller == fn; ei++) {
+            const emu_prof_edge_t &e = edges[ei];
+            fprintf(f, "cfn=%s\ncalls=%llu 0x%4.4X\n0x%4.4X %llu\n", ref(e.callee).c_str(),
+                    (unsigned long long)e.calls, e.callee, e.site, (unsigned long long)e.incl);
+        }
+    }
+    return fclose(f) == 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// Flat cycle profiler: cycles spent per instruction address.  At each
+// opcode fetch (SYNC cycle) the instruction fetched before it is charged
+// with the ticks since, so an instruction's count includes the interrupt
+// sequences that follow it and any idle-loop passes skipped after it.
+// Counts saturate at UINT32_MAX.
+//
+// Off by default; while off the bus path only sees a null pointer.  Like
+// the trace, profiling runs fast mode one instruction at a time.  Acts
+// on the calling thread's machine (N8Machine::prof).
+//
+// Per-symbol totals charge each address to the nearest label at or below
+// it (emu_labels); labels are the caller's (GUI thread) to read.
+//
+// Call graph: a shadow call stack is pushed on JSR, BRK and interrupt
+// entry (S down by 2 after a JSR; by 3, landing on a vector, after a BRK
+// sequence) and popped once S is back at a frame's return level after
+// RTS/RTI, or above it after anything else.  A return whose address was
+// pulled off (PLA PLA RTS) pops both frames; return-address tricks
+// (PHA PHA RTS) leave S below the frame and don't pop.  Functions are
+// named by their entry address; the bottom frame is whatever ran when
+// profiling started, or the reset handler since the last reset (a BRK
+// sequence landing on the reset vector).
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define EMU_PROF_DEPTH 256
+
+struct emu_prof_frame_t {
+    uint16_t fn;            // entry address
+    uint8_t  ret_s;         // S once returned
+    uint32_t edge;          // into emu_prof_t::edges
+    uint64_t enter;         // first opcode fetch
+};
+
+struct emu_prof_edge_t {
+    uint16_t caller, site, callee;  // site: the JSR, or the interrupted instruction
+    uint64_t calls;                 // returned calls
+    uint64_t incl;                  // their cycles, callee and below
+};
+
+struct emu_prof_t {
+    uint32_t cycles[1 << 16];
+    uint16_t pc;            // instruction being charged
+    uint64_t tick;          // its opcode fetch
+    uint8_t  op, s;         // its opcode, S when it started
+
+    uint64_t self[1 << 16];                 // per function entry
+    std::vector<emu_prof_edge_t> edges;
+    std::unordered_map<uint64_t, uint32_t> edge_index;
+    emu_prof_frame_t frames[EMU_PROF_DEPTH];
+    int depth;              // >= 1: frames[0] is the bottom
+};
+
+// Copy of the call graph, with calls still in flight counted as if they
+// returned at the time of the copy
+struct emu_prof_graph_t {
+    std::vector<std::pair<uint16_t, uint64_t>> self;    // entry, cycles; nonzero only
+    std::vector<emu_prof_edge_t> edges;
+    uint64_t total;
+};
+
+struct emu_prof_sym_t {
+    std::string name;       // label, or "$xxxx" below the first one
+    uint16_t    addr;
+    uint64_t    cycles;
+};
+
+void emu_prof_enable(bool en);      // starts from zero
+bool emu_prof_enabled();
+void emu_prof_clear();
+const uint32_t *emu_prof_cycles();  // 64K counts, nullptr while off
+void emu_prof_resync();             // charge nothing for the ticks since the last fetch
+
+// Per-symbol totals of a 64K count table, most cycles first
+void emu_prof_symbols(const uint32_t *cycles, std::vector<emu_prof_sym_t> &out);
+// Text table: one line per symbol with cycles, share and address
+bool emu_prof_save(const char *path, const uint32_t *cycles);
+
+bool emu_prof_graph(emu_prof_graph_t &out);     // false while off
+// callgrind format (KCachegrind): self cycles at each function's entry,
+// inclusive cycles and call counts at each call site
+bool emu_prof_callgrind(const char *path, const emu_prof_graph_t &graph);
+
+// Push/pop after an instruction that may have called or returned
+void emu_prof_stack(emu_prof_t &p, uint16_t pc, uint8_t s, uint64_t now);
+
+// Bus path, at a SYNC cycle: pc/op are the opcode's address and value,
+// s the stack pointer the previous instruction left
+static inline void emu_prof_charge(emu_prof_t &p, uint16_t pc, uint8_t op, uint8_t s, uint64_t now) {
+    // now < tick after going back in time (state restore): charge nothing
+    const uint64_t d = now > p.tick ? now - p.tick : 0;
+    const uint64_t v = p.cycles[p.pc] + d;
+    p.cycles[p.pc] = v > UINT32_MAX ? UINT32_MAX : (uint32_t)v;
+    p.self[p.frames[p.depth - 1].fn] += d;
+    if (p.op == 0x20 || p.op == 0x60 || p.op == 0x40 || (uint8_t)(p.s - s) == 3 ||
+        s > p.frames[p.depth - 1].ret_s) {
+        emu_prof_stack(p, pc, s, now);
+    }
+    p.pc = pc;
+    p.tick = now;
+    p.op = op;
+    p.s = s;
+}
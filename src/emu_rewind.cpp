@@ -0,0 +1,368 @@
+// Reverse execution, see emu_rewind.h.
+//
+// Going back to tick t: restore the newest checkpoint at or before t,
+// point the input replay at the first byte recorded at or after it, and
+// run forward to exactly t with breakpoints and watchpoints off.  The
+// previous instruction boundary and the last debug hit are found by a
+// scan over the same replay first.
+
+#include "emu_rewind.h"
+#include "emu_heat.h"
+#include "emu_input.h"
+#include "emu_prof.h"
+#include "emu_sched.h"
+#include "emu_state.h"
+#include "emu_tty.h"
+#include "gui_console.h"
+#include "m6502.h"
+#include "n8_machine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <stdio.h>
+#include <vector>
+
+#define EMU_REWIND_INTERVAL_INIT 100000     // cycles, until a replay has been timed
+#define EMU_REWIND_INTERVAL_MIN  10000
+#define EMU_REWIND_INTERVAL_MAX  4000000
+#define EMU_REWIND_STEP_WINDOW   16         // > longest instruction or interrupt sequence
+
+struct emu_rewind_seg_t {
+    emu_state_store_t    *st;
+    std::vector<uint64_t> ticks;    // state id -> tick
+};
+
+struct emu_rewind_input_t {
+    uint64_t tick;
+    uint8_t  c;
+};
+
+struct emu_rewind_t {
+    std::deque<emu_rewind_seg_t>    segs;       // oldest first, at most two
+    std::vector<emu_rewind_input_t> input;      // host TTY bytes, by tick
+    size_t   replay = 0;                        // next input entry to feed back
+    uint64_t last = 0;                          // newest tick reached
+    uint64_t interval = EMU_REWIND_INTERVAL_INIT;
+};
+
+// A checkpoint: segment and state id
+struct rewind_cp_t {
+    emu_rewind_seg_t *seg;
+    int id;
+    uint64_t tick() const { return seg->ticks[id]; }
+};
+
+static uint64_t rewind_newest(const emu_rewind_t &r) {
+    return r.segs.back().ticks.back();
+}
+
+static void rewind_checkpoint(emu_rewind_t &r) {
+    if (r.segs.empty() || r.segs.back().ticks.size() >= EMU_REWIND_SEGMENT) {
+        if (r.segs.size() == 2) {
+            emu_state_free(r.segs.front().st);
+            r.segs.pop_front();
+            // Input older than the oldest checkpoint can't be replayed any more
+            const uint64_t first = r.segs.front().ticks.front();
+            size_t keep = 0;
+            while (keep < r.input.size() && r.input[keep].tick < first) keep++;
+            r.input.erase(r.input.begin(), r.input.begin() + keep);
+            r.replay -= std::min(r.replay, keep);
+        }
+        r.segs.push_back({emu_state_new(), {}});
+    }
+    emu_rewind_seg_t &seg = r.segs.back();
+    emu_state_save(seg.st);
+    seg.ticks.push_back(n8->tick_count);
+}
+
+// Newest checkpoint at or before tick
+static bool rewind_find(emu_rewind_t &r, uint64_t tick, rewind_cp_t &cp) {
+    for (auto s = r.segs.rbegin(); s != r.segs.rend(); ++s) {
+        auto it = std::upper_bound(s->ticks.begin(), s->ticks.end(), tick);
+        if (it != s->ticks.begin()) {
+            cp.seg = &*s;
+            cp.id = (int)(it - s->ticks.begin()) - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void rewind_replay_event(uint64_t now);
+
+// Book the next recorded byte, or the end of the recorded history: live
+// input before then would part from the checkpoints ahead.
+static void rewind_replay_book(emu_rewind_t &r, uint64_t now) {
+    if (r.replay < r.input.size()) {
+        emu_sched_at(EMU_EV_REPLAY, std::max(now, r.input[r.replay].tick), rewind_replay_event);
+    } else if (now < r.last) {
+        emu_sched_at(EMU_EV_REPLAY, r.last, rewind_replay_event);
+    } else {
+        emu_sched_cancel(EMU_EV_REPLAY);
+        tty_hold_input(TTY_HOLD_REWIND, false);  // caught up: live input again
+    }
+}
+
+static void rewind_replay_event(uint64_t now) {
+    emu_rewind_t &r = *n8->rewind;
+    if (r.replay < r.input.size() && r.input[r.replay].tick <= now) {
+        tty_inject_char(r.input[r.replay++].c);
+    }
+    rewind_replay_book(r, now);
+}
+
+// Restore cp and line the input replay up with it.  An input log being
+// recorded or replayed no longer matches the machine.
+static void rewind_restore(emu_rewind_t &r, const rewind_cp_t &cp) {
+    if (emu_input_recording() || emu_input_replaying()) {
+        char msg[80];
+        snprintf(msg, sizeof(msg), "[input] went back from tick %llu: input log stopped\n",
+                 (unsigned long long)n8->tick_count);
+        gui_con_printmsg(msg);
+        emu_input_stop();
+    }
+    emu_state_restore(cp.seg->st, cp.id);
+    const uint64_t tick = cp.tick();
+    r.replay = 0;
+    while (r.replay < r.input.size() && r.input[r.replay].tick < tick) r.replay++;
+    tty_hold_input(TTY_HOLD_REWIND, true);
+    rewind_replay_book(r, tick);
+}
+
+// Trace, profile and heatmap off while re-executing: they already hold
+// what is being re-run
+struct rewind_unhooked_t {
+    emu_trace_t *trace;
+    emu_prof_t  *prof;
+    emu_heat_t  *heat;
+    rewind_unhooked_t() : trace(n8->trace), prof(n8->prof), heat(n8->heat) {
+        n8->trace = nullptr;
+        n8->prof = nullptr;
+        n8->heat = nullptr;
+    }
+    ~rewind_unhooked_t() {
+        n8->trace = trace;
+        n8->prof = prof;
+        n8->heat = heat;
+        emu_prof_resync();
+    }
+};
+
+// Debug stops off (and hits unreported) as well
+struct rewind_quiet_t {
+    bool bp, wp;
+    rewind_unhooked_t unhooked;
+    rewind_quiet_t() : bp(n8->bp_enable), wp(n8->wp_enable) {
+        n8->bp_enable = n8->wp_enable = false;
+    }
+    ~rewind_quiet_t() {
+        n8->bp_enable = bp;
+        n8->wp_enable = wp;
+    }
+};
+
+// Run forward to exactly tick; the time it takes sets the interval
+static void rewind_run_to(emu_rewind_t &r, uint64_t tick) {
+    if (tick <= n8->tick_count) return;
+    rewind_quiet_t quiet;
+    const uint64_t cycles = tick - n8->tick_count;
+    const auto t0 = std::chrono::steady_clock::now();
+    while (n8->tick_count < tick) emulator_run(tick - n8->tick_count, nullptr);
+    const double us = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - t0).count();
+    if (us > 200.0) {
+        // Going back replays up to two intervals (scan, then position)
+        const double interval = cycles / us * EMU_REWIND_BUDGET_US / 2;
+        r.interval = (uint64_t)std::max((double)EMU_REWIND_INTERVAL_MIN,
+                                        std::min((double)EMU_REWIND_INTERVAL_MAX, interval));
+    }
+}
+
+static void rewind_goto(emu_rewind_t &r, const rewind_cp_t &cp, uint64_t tick) {
+    rewind_restore(r, cp);
+    rewind_run_to(r, tick);
+}
+
+void emu_rewind_enable(bool en) {
+    if (!en) {
+        emu_rewind_free();
+        return;
+    }
+    if (n8->rewind) return;
+    n8->rewind = new emu_rewind_t();
+    n8->rewind->last = n8->tick_count;
+    rewind_checkpoint(*n8->rewind);
+}
+
+bool emu_rewind_enabled() {
+    return n8->rewind != nullptr;
+}
+
+void emu_rewind_free() {
+    emu_rewind_t *r = n8->rewind;
+    if (!r) return;
+    for (auto &s : r->segs) emu_state_free(s.st);
+    delete r;
+    n8->rewind = nullptr;
+    emu_sched_cancel(EMU_EV_REPLAY);
+    tty_hold_input(TTY_HOLD_REWIND, false);
+}
+
+void emu_rewind_record() {
+    emu_rewind_t *r = n8->rewind;
+    if (!r) return;
+    const uint64_t now = n8->tick_count;
+    if (now > r->last) r->last = now;
+    if (now >= rewind_newest(*r) + r->interval) rewind_checkpoint(*r);
+}
+
+void emu_rewind_input(uint64_t now, uint8_t c) {
+    emu_rewind_t *r = n8->rewind;
+    if (!r) return;
+    r->input.push_back({now, c});
+    r->replay = r->input.size();
+}
+
+void emu_rewind_mark() {
+    emu_rewind_t *r = n8->rewind;
+    if (!r) return;
+    const uint64_t now = n8->tick_count;
+
+    // Drop the future: checkpoints from now on and input not yet replayed
+    while (!r->segs.empty()) {
+        emu_rewind_seg_t &s = r->segs.back();
+        const int keep = (int)(std::lower_bound(s.ticks.begin(), s.ticks.end(), now) - s.ticks.begin());
+        if (keep) {
+            emu_state_truncate(s.st, keep);
+            s.ticks.resize(keep);
+            break;
+        }
+        emu_state_free(s.st);
+        r->segs.pop_back();
+    }
+    r->input.resize(r->replay);
+    emu_sched_cancel(EMU_EV_REPLAY);
+    tty_hold_input(TTY_HOLD_REWIND, false);
+    r->last = now;
+    rewind_checkpoint(*r);
+}
+
+emu_rewind_result_t emu_rewind_step() {
+    emu_rewind_t *r = n8->rewind;
+    if (!r) return EMU_REWIND_OFF;
+    const uint64_t now = n8->tick_count;
+    const uint64_t start = now > EMU_REWIND_STEP_WINDOW ? now - EMU_REWIND_STEP_WINDOW : 0;
+    rewind_cp_t cp;
+    if (!rewind_find(*r, start, cp) && (now == 0 || !rewind_find(*r, now - 1, cp))) {
+        return EMU_REWIND_BEGIN;    // already at the oldest state
+    }
+
+    // Scan the last few cycles for the newest boundary before now
+    rewind_goto(*r, cp, std::max(start, cp.tick()));
+    uint64_t boundary = 0;
+    bool found = false;
+    {
+        rewind_quiet_t quiet;
+        while (n8->tick_count < now) {
+            emulator_step();
+            if ((n8->pins & M6502_SYNC) && n8->tick_count < now) {
+                boundary = n8->tick_count;
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        rewind_restore(*r, cp);
+        return EMU_REWIND_BEGIN;
+    }
+    rewind_goto(*r, cp, boundary);
+    return EMU_REWIND_STOPPED;
+}
+
+emu_rewind_result_t emu_rewind_continue(emu_stop_reason_t *reason) {
+    emu_rewind_t *r = n8->rewind;
+    if (!r) return EMU_REWIND_OFF;
+    N8Machine &m = *n8;
+    const uint64_t now = m.tick_count;
+
+    // Newest checkpoint first; each one's span ends at the next (or now)
+    std::vector<rewind_cp_t> cps;
+    for (auto &s : r->segs) {
+        for (int id = 0; id < (int)s.ticks.size() && s.ticks[id] < now; id++) cps.push_back({&s, id});
+    }
+    for (int k = (int)cps.size() - 1; k >= 0; k--) {
+        const uint64_t end = k + 1 < (int)cps.size() ? cps[k + 1].tick() : now;
+        rewind_unhooked_t unhooked;
+        rewind_restore(*r, cps[k]);
+
+        bool hit = false;
+        uint64_t hit_tick = 0;
+        emu_stop_reason_t hit_reason = EMU_STOP_CYCLES;
+        uint16_t wp_addr = 0;
+        int wp_type = 0;
+        m.dbg_quiet = true;
+        while (m.tick_count < end) {
+            emu_stop_reason_t why;
+            emulator_run(end - m.tick_count, &why);
+            if (why == EMU_STOP_CYCLES) continue;
+            if (m.tick_count < now) {
+                hit = true;
+                hit_tick = m.tick_count;
+                hit_reason = why;
+                wp_addr = m.wp_addr;
+                wp_type = m.wp_type;
+            }
+            m.bp_hit = false;
+            m.wp_hit_flag = false;
+        }
+        m.dbg_quiet = false;
+        if (!hit) continue;
+
+        rewind_goto(*r, cps[k], hit_tick);
+        if (hit_reason == EMU_STOP_BREAKPOINT) {
+            m.bp_hit = true;
+        } else {
+            m.wp_hit_flag = true;
+            m.wp_addr = wp_addr;
+            m.wp_type = wp_type;
+        }
+        if (reason) *reason = hit_reason;
+        return EMU_REWIND_STOPPED;
+    }
+
+    rewind_cp_t first = {&r->segs.front(), 0};
+    rewind_restore(*r, first);
+    if (reason) *reason = EMU_STOP_CYCLES;
+    return EMU_REWIND_BEGIN;
+}
+
+bool emu_rewind_seek(uint64_t tick) {
+    emu_rewind_t *r = n8->rewind;
+    if (!r) return false;
+    tick = std::max(emu_rewind_first(), std::min(tick, r->last));
+    rewind_cp_t cp;
+    if (!rewind_find(*r, tick, cp)) return false;
+    // Forward within reach of the current state: no need to restore
+    if (tick >= n8->tick_count && cp.tick() <= n8->tick_count) {
+        rewind_run_to(*r, tick);
+    } else {
+        rewind_goto(*r, cp, tick);
+    }
+    return true;
+}
+
+uint64_t emu_rewind_first() {
+    emu_rewind_t *r = n8->rewind;
+    return r ? r->segs.front().ticks.front() : n8->tick_count;
+}
+
+uint64_t emu_rewind_last() {
+    emu_rewind_t *r = n8->rewind;
+    return r ? std::max(r->last, n8->tick_count) : n8->tick_count;
+}
+
+uint64_t emu_rewind_interval() {
+    emu_rewind_t *r = n8->rewind;
+    return r ? r->interval : 0;
+}
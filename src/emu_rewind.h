@@ -0,0 +1,56 @@
+#pragma once
+
+// Reverse execution: periodic checkpoints (emu_state.h) plus exact
+// re-execution from the nearest one.  The core is deterministic given its
+// input, so the only thing recorded between checkpoints is host TTY input
+// (byte and the cycle it reached the FIFO); a replay feeds it back at the
+// same cycles and holds live input back until it reaches the end of the
+// recorded history.
+//
+// After going back, running forward again replays the same history.  Any
+// other change from outside the CPU (debugger memory/register write,
+// reset) cuts the history at that point.  Both reach here through
+// emu_input_note() (emu_input.h).
+//
+// The checkpoint interval follows the measured replay speed so that going
+// back costs about EMU_REWIND_BUDGET_US.  History is kept in two segments
+// of up to EMU_REWIND_SEGMENT checkpoints; when the newer one fills, the
+// older one is dropped.  Everything acts on the calling thread's machine.
+
+#include "emulator.h"
+
+#include <stdint.h>
+
+#define EMU_REWIND_BUDGET_US 2000
+#define EMU_REWIND_SEGMENT   1024
+
+struct emu_rewind_t;    // N8Machine::rewind
+
+typedef enum {
+    EMU_REWIND_STOPPED,     // arrived: instruction boundary, breakpoint or watchpoint
+    EMU_REWIND_BEGIN,       // nothing older recorded; left at the oldest state
+    EMU_REWIND_OFF          // no history
+} emu_rewind_result_t;
+
+void emu_rewind_enable(bool en);    // starts history at the current state
+bool emu_rewind_enabled();
+void emu_rewind_free();             // drop all history (machine teardown)
+
+// Call between emulator_run()/emulator_step() calls: checkpoints when the
+// interval has passed.
+void emu_rewind_record();
+void emu_rewind_input(uint64_t now, uint8_t c);     // TTY byte reached the FIFO
+void emu_rewind_mark();                             // outside change: cut here
+
+// Back to the start of the previous instruction
+emu_rewind_result_t emu_rewind_step();
+// Back to the most recent breakpoint or watchpoint hit before now (as set
+// and enabled); *reason says which, hit flags are left as emulator_run()
+// would leave them.
+emu_rewind_result_t emu_rewind_continue(emu_stop_reason_t *reason);
+// To any recorded cycle in [emu_rewind_first(), emu_rewind_last()]
+bool emu_rewind_seek(uint64_t tick);
+
+uint64_t emu_rewind_first();        // oldest reachable tick
+uint64_t emu_rewind_last();         // newest recorded tick (>= now after going back)
+uint64_t emu_rewind_interval();     // current checkpoint interval, cycles
@@ -0,0 +1,47 @@
+#pragma once
+
+// Single-producer / single-consumer lock-free ring buffer.
+// One thread may push(), one other thread may pop(); no locks, no allocation.
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t N>
+struct emu_ring_t {
+    static_assert((N & (N - 1)) == 0, "emu_ring_t size must be a power of two");
+
+    T buf[N];
+    std::atomic<size_t> head{0};   // next slot to write (producer owned)
+    std::atomic<size_t> tail{0};   // next slot to read (consumer owned)
+
+    // Producer: returns false if the ring is full.
+    bool push(const T& v) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) return false;
+        buf[h & (N - 1)] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: returns false if the ring is empty.
+    bool pop(T& v) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        v = buf[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    // Consumer: drop everything currently queued.
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+};
@@ -0,0 +1,88 @@
+// Device event scheduler, see emu_sched.h.
+
+#include "emu_sched.h"
+#include "n8_machine.h"
+
+static void heap_swap(emu_sched_t &s, int i, int j) {
+    int t = s.heap[i]; s.heap[i] = s.heap[j]; s.heap[j] = t;
+    s.heap_slot[s.heap[i]] = i + 1;
+    s.heap_slot[s.heap[j]] = j + 1;
+}
+
+static void sift_up(emu_sched_t &s, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (s.events[s.heap[parent]].when <= s.events[s.heap[i]].when) break;
+        heap_swap(s, i, parent);
+        i = parent;
+    }
+}
+
+static void sift_down(emu_sched_t &s, int i) {
+    while (1) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < s.heap_len && s.events[s.heap[l]].when < s.events[s.heap[m]].when) m = l;
+        if (r < s.heap_len && s.events[s.heap[r]].when < s.events[s.heap[m]].when) m = r;
+        if (m == i) break;
+        heap_swap(s, i, m);
+        i = m;
+    }
+}
+
+static void update_due(emu_sched_t &s) {
+    s.due = s.heap_len ? s.events[s.heap[0]].when : EMU_SCHED_NEVER;
+}
+
+void emu_sched_init() {
+    emu_sched_t &s = n8->sched;
+    for (int id = 0; id < EMU_EV_COUNT; id++) s.heap_slot[id] = 0;
+    s.heap_len = 0;
+    update_due(s);
+}
+
+void emu_sched_at(emu_event_id_t id, uint64_t when, emu_event_fn fn) {
+    emu_sched_t &s = n8->sched;
+    s.events[id].fn = fn;
+    if (!s.heap_slot[id]) {
+        s.events[id].when = when;
+        s.heap[s.heap_len] = id;
+        s.heap_slot[id] = ++s.heap_len;
+        sift_up(s, s.heap_len - 1);
+    } else {
+        const bool earlier = when < s.events[id].when;
+        s.events[id].when = when;
+        if (earlier) sift_up(s, s.heap_slot[id] - 1);
+        else sift_down(s, s.heap_slot[id] - 1);
+    }
+    update_due(s);
+}
+
+void emu_sched_cancel(emu_event_id_t id) {
+    emu_sched_t &s = n8->sched;
+    const int i = s.heap_slot[id] - 1;
+    if (i < 0) return;
+    s.heap_slot[id] = 0;
+    if (--s.heap_len != i) {
+        const int moved = s.heap[s.heap_len];
+        s.heap[i] = moved;
+        s.heap_slot[moved] = i + 1;
+        sift_down(s, i);
+        sift_up(s, s.heap_slot[moved] - 1);
+    }
+    update_due(s);
+}
+
+bool emu_sched_booked(emu_event_id_t id) {
+    return n8->sched.heap_slot[id] != 0;
+}
+
+void emu_sched_run(uint64_t now) {
+    emu_sched_t &s = n8->sched;
+    // Unbook before calling, so a handler can book its slot again
+    while (s.heap_len && s.events[s.heap[0]].when <= now) {
+        const int id = s.heap[0];
+        emu_sched_cancel((emu_event_id_t)id);
+        s.events[id].fn(now);
+    }
+    update_due(s);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// Device event scheduler.  Devices book their next interesting cycle (UART
+// byte time, timer expiry, cursor blink, ...) instead of being ticked every
+// cycle; the bus only compares tick_count against the earliest deadline,
+// and batched execution (fast mode, idle skipping) runs up to it.
+//
+// Each event source has one slot (emu_event_id_t).  Booked slots live in a
+// binary min-heap keyed by deadline.  Each machine has its own scheduler;
+// these calls act on the calling thread's (n8_machine.h).
+
+#include <stdint.h>
+
+typedef enum {
+    EMU_EV_TTY_RX,          // next host byte moves into the TTY input FIFO
+    EMU_EV_REPLAY,          // next recorded input byte is due (emu_rewind)
+    EMU_EV_INPUT,           // next TTY byte from an input log is due (emu_input)
+    EMU_EV_COUNT
+} emu_event_id_t;
+
+typedef void (*emu_event_fn)(uint64_t now);
+
+#define EMU_SCHED_NEVER UINT64_MAX
+
+struct emu_event_t {
+    uint64_t when;
+    emu_event_fn fn;
+};
+
+// Per-machine scheduler state (N8Machine::sched)
+struct emu_sched_t {
+    uint64_t    due = EMU_SCHED_NEVER;          // earliest deadline, EMU_SCHED_NEVER if none
+    emu_event_t events[EMU_EV_COUNT] {};
+    int         heap[EMU_EV_COUNT + 1] {};      // event ids, earliest first (+1: sift_down's
+                                                // child index stays in bounds for one source)
+    int         heap_slot[EMU_EV_COUNT] {};     // index in heap[] + 1, 0 if not booked
+    int         heap_len = 0;
+};
+
+void emu_sched_init();                                              // cancel everything
+void emu_sched_at(emu_event_id_t id, uint64_t when, emu_event_fn fn);  // book or move
+void emu_sched_cancel(emu_event_id_t id);
+bool emu_sched_booked(emu_event_id_t id);
+void emu_sched_run(uint64_t now);   // fire every event due at or before now, in order
+
+// emu_sched_poll(now), the per-cycle check on the bus path, is in
+// n8_machine.h
@@ -0,0 +1,130 @@
+// Save states, see emu_state.h.
+//
+// Each snapshot has a page map: for every 256-byte page, the index of the
+// copy in the pool that holds its contents as of that snapshot.  The store
+// remembers which snapshot the machine's memory last matched (base) and
+// the first generation written after that (since), so
+//
+//   save:    pages written since `since` get new pool copies, the rest
+//            reuse base's map entries;
+//   restore: pages written since `since`, plus pages whose map entry
+//            differs between base and the target, are copied back.
+//
+// Pool copies are appended in save order, so dropping the newest
+// snapshots just shortens the pool.
+
+#include "emu_state.h"
+#include "emu_bus.h"
+#include "n8_machine.h"
+
+#include <queue>
+#include <vector>
+
+struct emu_state_snap_t {
+    m6502_t             cpu;
+    uint64_t            pins;
+    uint64_t            tick_count;
+    uint16_t            cur_instruction;
+    uint8_t             irq_flags;
+    emu_sched_t         sched;
+    std::queue<uint8_t> tty;            // firmware-visible input FIFO
+    uint32_t            page[256];      // pool index per page
+    size_t              pool_start;     // pool size before this snapshot's copies
+};
+
+struct emu_state_store_t {
+    N8Machine                    *m;
+    std::vector<emu_state_snap_t> snaps;
+    std::vector<uint8_t>          pool;         // 256 bytes per page copy
+    int                           base = -1;    // snapshot memory matched, -1: none
+    uint32_t                      since = 0;    // first generation after base
+};
+
+emu_state_store_t *emu_state_new() {
+    emu_state_store_t *st = new emu_state_store_t();
+    st->m = n8;
+    return st;
+}
+
+void emu_state_free(emu_state_store_t *st) {
+    delete st;
+}
+
+int emu_state_save(emu_state_store_t *st) {
+    N8Machine &m = *st->m;
+    st->snaps.emplace_back();
+    emu_state_snap_t &s = st->snaps.back();
+    const emu_state_snap_t *base = st->base >= 0 ? &st->snaps[st->base] : nullptr;
+
+    s.pool_start = st->pool.size();
+    for (int page = 0; page < 256; page++) {
+        if (base && m.mem_page_gen[page] < st->since) {
+            s.page[page] = base->page[page];
+            continue;
+        }
+        const size_t at = st->pool.size();
+        st->pool.insert(st->pool.end(), &m.mem[page << 8], &m.mem[page << 8] + 256);
+        s.page[page] = (uint32_t)(at >> 8);
+    }
+
+    s.cpu = m.cpu;
+    m6502_snapshot_onsave(&s.cpu);
+    s.pins = m.pins;
+    s.tick_count = m.tick_count;
+    s.cur_instruction = m.cur_instruction;
+    s.irq_flags = m.irq_flags;
+    s.sched = m.sched;
+    s.tty = m.tty.buff;
+
+    st->base = (int)st->snaps.size() - 1;
+    st->since = m.mem_gen++ + 1;
+    return st->base;
+}
+
+bool emu_state_restore(emu_state_store_t *st, int id) {
+    if (id < 0 || id >= (int)st->snaps.size()) return false;
+    N8Machine *prev = n8_machine_bind(st->m);   // MEM_TOUCH and friends act on n8
+    N8Machine &m = *st->m;
+    const emu_state_snap_t &s = st->snaps[id];
+    const emu_state_snap_t *base = st->base >= 0 ? &st->snaps[st->base] : nullptr;
+
+    for (int page = 0; page < 256; page++) {
+        if (base && m.mem_page_gen[page] < st->since && base->page[page] == s.page[page]) continue;
+        memcpy(&m.mem[page << 8], &st->pool[(size_t)s.page[page] << 8], 256);
+        MEM_TOUCH(m, page << 8);
+    }
+
+    m6502_t cpu = s.cpu;
+    m6502_snapshot_onload(&cpu, &m.cpu);
+    m.cpu = cpu;
+    m.pins = s.pins;
+    m.tick_count = s.tick_count;
+    m.cur_instruction = s.cur_instruction;
+    m.irq_flags = s.irq_flags;
+    m.sched = s.sched;
+    m.tty.buff = s.tty;
+    // Host bytes still waiting in the ring need their UART event again
+    if (!m.tty.rx_ring.empty()) m.tty.rx_pending = true;
+    emulator_idle_reset();
+
+    st->base = id;
+    st->since = m.mem_gen++ + 1;
+    n8_machine_bind(prev);
+    return true;
+}
+
+void emu_state_truncate(emu_state_store_t *st, int count) {
+    if (count < 0) count = 0;
+    if (count >= (int)st->snaps.size()) return;
+    st->pool.resize(st->snaps[count].pool_start);
+    st->snaps.resize(count);
+    if (st->base >= count) st->base = -1;     // next restore copies everything
+}
+
+int emu_state_count(const emu_state_store_t *st) {
+    return (int)st->snaps.size();
+}
+
+size_t emu_state_pages(const emu_state_store_t *st) {
+    return st->pool.size() >> 8;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// In-memory save states of a whole machine: CPU, pins, tick count, memory,
+// IRQ, TTY input FIFO and scheduled device events.  Debug flags,
+// breakpoints and host-side input are settings, not state, and are left
+// alone.
+//
+// A store keeps any number of snapshots of one machine.  Memory is held in
+// 256-byte pages shared between snapshots: a save copies only the pages
+// written since the store's last save or restore (the page write
+// generations, see emulator_mem_epoch()) and points at earlier copies for
+// the rest; a restore copies back only the pages that differ from what the
+// machine holds now.  Restoring one snapshot and saving again branches off
+// it, so the snapshots form a tree.
+//
+// Memory written behind the bus (plain n8->mem[] stores) is not seen; use
+// emulator_write_mem().
+
+#include <stddef.h>
+
+struct N8Machine;
+struct emu_state_store_t;
+
+emu_state_store_t *emu_state_new();         // for the calling thread's machine
+void   emu_state_free(emu_state_store_t *st);
+
+int    emu_state_save(emu_state_store_t *st);           // returns the snapshot id
+bool   emu_state_restore(emu_state_store_t *st, int id);
+void   emu_state_truncate(emu_state_store_t *st, int count);  // keep ids < count
+int    emu_state_count(const emu_state_store_t *st);
+size_t emu_state_pages(const emu_state_store_t *st);    // page copies held
@@ -0,0 +1,601 @@
+// Emulation thread: runs the CPU independent of the render loop.
+//
+// GUI thread                          emulation thread
+//   emu_thread_post() --cmd_ring-->     drain commands, gdb_stub_poll()
+//                                       emulator_run() in chunks sized to take
+//                                       about EMU_CHUNK_US between clock checks
+//                                       (sleeps on host input while the CPU idles,
+//                                       or between batches in a paced clock mode)
+//   emu_thread_latest() <--snapshot--   publish() every EMU_PUBLISH_MS or on change
+//   (wake hook)         <-----------    on change only
+//
+// Snapshots are triple buffered: the emulation thread fills its back buffer
+// and swaps it into the middle slot; the GUI swaps the middle slot into its
+// front buffer once per frame.  Neither side ever waits on the other.
+
+#include "emu_thread.h"
+#include "emu_ring.h"
+#include "emulator.h"
+#include "emu_cov.h"
+#include "emu_heat.h"
+#include "emu_input.h"
+#include "emu_prof.h"
+#include "emu_rewind.h"
+#include "emu_trace.h"
+#include "emu_tty.h"
+#include "gdb_stub.h"
+#include "m6502.h"
+#include "n8_machine.h"
+#include "utils.h"
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+typedef std::chrono::steady_clock emu_clock;
+
+static const int      EMU_CHUNK_US    = 100;    // free-run time between clock checks
+static const uint64_t EMU_CHUNK_MIN   = 1000;   // ticks, whatever the measured speed
+static const uint64_t EMU_CHUNK_MAX   = 65536;
+static const int      EMU_SLICE_MS    = 5;      // run time between command/GDB polls
+static const int      EMU_PUBLISH_MS  = 16;     // snapshot rate while running
+static const int      EMU_PACE_US     = 1000;   // paced run granularity
+static const int      EMU_PACE_LAG_MS = 50;     // larger backlogs are dropped, not caught up
+
+// ---- Emulation state (emulation thread only) ----
+static bool run_emulator = false;
+static bool step_emulator = false;
+static bool gdb_halted = false;
+static uint32_t dbg_gen = 1;        // bumped on every dbg_flags edit
+static uint32_t heat_gen = 0;       // bumped on every heatmap on/off
+static uint64_t chunk_ticks = EMU_CHUNK_MIN;    // see chunk_tune()
+
+// Paced clock: tick_count is due to reach pace_tick0 + elapsed * pace_hz.
+// Measuring from a fixed origin keeps sleep overshoot from accumulating.
+static uint32_t pace_hz = 0;
+static bool pace_valid = false;     // origin needs setting before the next slice
+static emu_clock::time_point pace_t0;
+static uint64_t pace_tick0 = 0;
+
+// Trace copy for the GUI: the GUI owns it unless a copy is wanted
+static std::vector<emu_trace_entry_t> trace_copy;
+static uint64_t trace_copy_tick = 0;
+static std::atomic<bool> trace_copy_wanted{false};
+static emu_prof_graph_t prof_graph_copy;
+static std::atomic<bool> prof_graph_wanted{false};
+
+static void (*wake_gui)() = nullptr;
+static std::thread* emu_thread_ptr = nullptr;
+static std::atomic<bool> emu_quit{false};
+static emu_ring_t<emu_cmd_t, 256> cmd_ring;
+
+// ---- Snapshot triple buffer ----
+#define SNAP_INDEX 0x3
+#define SNAP_FRESH 0x4
+
+static emu_snapshot_t snap_buf[3];
+static uint32_t snap_mem_seen[3];   // memory generation each buffer is current to
+static uint32_t snap_dbg_seen[3];   // dbg_gen each buffer is current to
+static int snap_back = 0;           // emulation thread owned
+static int snap_front = 1;          // GUI thread owned
+static std::atomic<int> snap_middle{2};
+
+static emu_clock::time_point last_pub_time;
+static uint64_t last_pub_ticks = 0;
+
+static void publish() {
+    emu_snapshot_t& s = snap_buf[snap_back];
+
+    emu_clock::time_point now = emu_clock::now();
+    double secs = std::chrono::duration<double>(now - last_pub_time).count();
+    s.ticks_per_sec = (secs > 0.0) ? (n8->tick_count - last_pub_ticks) / secs : 0.0;
+    s.chunk_ticks = chunk_ticks;
+    s.target_hz = pace_hz;
+    last_pub_time = now;
+    last_pub_ticks = n8->tick_count;
+
+    s.a = m6502_a(&n8->cpu);
+    s.x = m6502_x(&n8->cpu);
+    s.y = m6502_y(&n8->cpu);
+    s.s = m6502_s(&n8->cpu);
+    s.p = m6502_p(&n8->cpu);
+    s.pc = m6502_pc(&n8->cpu);
+    s.ci = emulator_getci();
+    s.pins = n8->pins;
+    s.tick_count = n8->tick_count;
+    s.running = run_emulator;
+    s.gdb_halted = gdb_halted;
+    s.gdb_connected = gdb_stub_is_connected();
+    s.bp_enable = emulator_bp_enabled();
+    s.fast = emulator_fast_enabled();
+    s.history_first = emu_rewind_first();
+    s.history_last = emu_rewind_last();
+    s.trace_capacity = emu_trace_capacity();
+    s.prof_on = emu_prof_enabled();
+    if (s.prof_on) memcpy(s.prof, emu_prof_cycles(), sizeof(s.prof));
+    s.heat_on = emu_heat_enabled();
+    s.heat_gen = heat_gen;
+    if (s.heat_on) memcpy(&s.heat, emu_heat_counts(), sizeof(s.heat));
+    s.cov_on = emu_cov_enabled();
+    if (s.cov_on) memcpy(s.cov, emu_cov_hits(), sizeof(s.cov));
+
+    // Copy only the pages written since this buffer was last filled
+    uint32_t since = snap_mem_seen[snap_back];
+    uint32_t gen = emulator_mem_epoch();
+    for (int page = 0; page < 256; page++) {
+        if (n8->mem_page_gen[page] >= since) {
+            memcpy(&s.mem[page << 8], &n8->mem[page << 8], 256);
+        }
+    }
+    snap_mem_seen[snap_back] = gen + 1;
+
+    if (snap_dbg_seen[snap_back] != dbg_gen) {
+        memcpy(s.dbg_flags, n8->dbg_flags, sizeof(s.dbg_flags));
+        snap_dbg_seen[snap_back] = dbg_gen;
+    }
+
+    snap_back = snap_middle.exchange(snap_back | SNAP_FRESH, std::memory_order_acq_rel) & SNAP_INDEX;
+}
+
+// ---- GDB stub callbacks (run on the emulation thread via gdb_stub_poll) ----
+
+static uint8_t gdb_read_reg8(int reg_id) {
+    switch (reg_id) {
+        case 0: return emulator_read_a();
+        case 1: return emulator_read_x();
+        case 2: return emulator_read_y();
+        case 3: return emulator_read_s();
+        case 4: return emulator_read_p();
+        default: return 0;
+    }
+}
+
+static uint16_t gdb_read_reg16(int reg_id) {
+    if (reg_id == 5) return emulator_getpc();
+    return 0;
+}
+
+static void gdb_write_reg8(int reg_id, uint8_t val) {
+    if (reg_id >= 0 && reg_id <= 4) emu_input_apply(EMU_IN_REG, reg_id, val);
+}
+
+static void gdb_write_reg16(int reg_id, uint16_t val) {
+    if (reg_id == 5) emu_input_apply(EMU_IN_REG, reg_id, val);
+}
+
+static uint8_t gdb_read_mem(uint16_t addr) {
+    return n8->mem[addr];
+}
+
+static void gdb_write_mem(uint16_t addr, uint8_t val) {
+    emu_input_apply(EMU_IN_MEM, addr, val);
+}
+
+static int gdb_step_instruction(void) {
+    int guard = gdb_stub_get_step_guard();
+    int ticks = 0;
+    do {
+        emulator_step();
+        ticks++;
+        if (ticks >= guard) return 4; // SIGILL — likely jammed
+    } while (!(n8->pins & M6502_SYNC));
+    emu_rewind_record();
+    return 5; // SIGTRAP
+}
+
+static int gdb_reverse_step(void) {
+    return emu_rewind_step() == EMU_REWIND_STOPPED ? 5 : 0;
+}
+
+static int gdb_reverse_continue(uint16_t* wp_addr, int* wp_type) {
+    emu_stop_reason_t reason;
+    if (emu_rewind_continue(&reason) != EMU_REWIND_STOPPED) return 0;
+    if (reason == EMU_STOP_WATCHPOINT) {
+        *wp_addr = emulator_wp_hit_addr();
+        *wp_type = emulator_wp_hit_type();
+    }
+    emulator_clear_bp_hit();
+    emulator_clear_wp_hit();
+    return 5;
+}
+
+static void gdb_set_breakpoint(uint16_t addr) {
+    emulator_dbg_set(addr, DBG_EXEC);
+    dbg_gen++;
+    emulator_enablebp(true);
+}
+
+static void gdb_clear_breakpoint(uint16_t addr) {
+    emulator_dbg_clear(addr, DBG_EXEC);
+    dbg_gen++;
+    // Disable BP scanning if no breakpoints remain
+    if (!emulator_dbg_any(DBG_EXEC)) emulator_enablebp(false);
+}
+
+// GDB Z-packet type -> DBG_* flags: 2=write, 3=read, 4=access
+static uint8_t gdb_wp_flags(int type) {
+    switch (type) {
+        case 2: return DBG_WRITE;
+        case 3: return DBG_READ;
+        case 4: return DBG_WRITE | DBG_READ;
+        default: return 0;
+    }
+}
+
+static void gdb_set_watchpoint(uint16_t addr, int type) {
+    emulator_dbg_set(addr, gdb_wp_flags(type));
+    dbg_gen++;
+    emulator_enablewp(true);
+}
+
+static void gdb_clear_watchpoint(uint16_t addr, int type) {
+    emulator_dbg_clear(addr, gdb_wp_flags(type));
+    dbg_gen++;
+    // Disable WP scanning if no watchpoints remain
+    if (!emulator_dbg_any(DBG_READ | DBG_WRITE)) emulator_enablewp(false);
+}
+
+static void gdb_continue_exec(void) {
+    run_emulator = true;
+}
+
+static void gdb_halt(void) {
+    run_emulator = false;
+}
+
+static uint16_t gdb_get_pc(void) {
+    return emulator_getpc();
+}
+
+static int gdb_get_stop_reason(void) {
+    return 5; // SIGTRAP default
+}
+
+static void gdb_reset(void) {
+    // D47: Use M6502_RES pin, NOT emulator_reset()
+    emu_input_apply(EMU_IN_RESET, 0, EMU_IN_RESET_CPU);
+}
+
+// ---- Thread loop ----
+
+// Returns true if anything visible to the GUI changed
+static bool drain_commands() {
+    bool changed = false;
+    emu_cmd_t cmd;
+    while (cmd_ring.pop(cmd)) {
+        changed = true;
+        switch (cmd.type) {
+            case EMU_CMD_RUN:       run_emulator = true; break;
+            case EMU_CMD_PAUSE:     run_emulator = false; break;
+            case EMU_CMD_STEP:      step_emulator = true; break;
+            case EMU_CMD_RESET:     emu_input_apply(EMU_IN_RESET, 0, EMU_IN_RESET_MACHINE); break;
+            case EMU_CMD_BP_ENABLE: emulator_enablebp(cmd.value != 0); break;
+            case EMU_CMD_BP_SET:    emulator_setbp_addr(cmd.addr); dbg_gen++; break;
+            case EMU_CMD_BP_CLEAR:  emulator_dbg_clear(cmd.addr, DBG_EXEC); dbg_gen++; break;
+            case EMU_CMD_BP_LOG:    emulator_logbp(); break;
+            case EMU_CMD_FAST:      emulator_enablefast(cmd.value != 0); break;
+            case EMU_CMD_PACE:
+                pace_hz = emu_pace_hz((emu_pace_t)cmd.value);
+                pace_valid = false;
+                break;
+            case EMU_CMD_STEP_BACK:
+                if (!run_emulator && !gdb_halted) emu_rewind_step();
+                break;
+            case EMU_CMD_SEEK:
+                if (gdb_halted) break;
+                run_emulator = false;
+                emu_rewind_seek(cmd.tick);
+                break;
+            case EMU_CMD_TRACE:     emu_trace_enable((uint32_t)cmd.tick); break;
+            case EMU_CMD_PROF:
+                if (cmd.value == EMU_PROF_CLEAR) emu_prof_clear();
+                else emu_prof_enable(cmd.value == EMU_PROF_ON);
+                break;
+            case EMU_CMD_HEAT:
+                emu_heat_enable(cmd.value != 0);
+                heat_gen++;
+                break;
+            case EMU_CMD_COV:
+                if (cmd.value == EMU_COV_CMD_CLEAR) emu_cov_clear();
+                else emu_cov_enable(cmd.value == EMU_COV_CMD_ON);
+                break;
+            case EMU_CMD_QUIT:      emu_quit.store(true); break;
+        }
+    }
+    return changed;
+}
+
+static bool poll_gdb() {
+    switch (gdb_stub_poll()) {
+        case GDB_POLL_HALTED:
+            run_emulator = false;
+            gdb_halted = true;
+            emulator_enablebp(true);
+            return true;
+        case GDB_POLL_RESUMED:
+            gdb_halted = false;
+            run_emulator = true;
+            return true;
+        case GDB_POLL_STEPPED:
+            gdb_halted = true;
+            run_emulator = false;
+            return true;
+        case GDB_POLL_DETACHED:
+            gdb_halted = false;
+            // D44: clear all GDB breakpoints and watchpoints on disconnect
+            emulator_dbg_clear_all(DBG_EXEC | DBG_READ | DBG_WRITE);
+            dbg_gen++;
+            emulator_enablebp(false);
+            emulator_enablewp(false);
+            return true;
+        case GDB_POLL_KILL:
+            gdb_halted = false;
+            run_emulator = true;
+            return true;
+        case GDB_POLL_NONE:
+            break;
+    }
+    return false;
+}
+
+// Handle a breakpoint/watchpoint stop.  Returns true if execution stopped.
+static bool run_stopped(emu_stop_reason_t reason) {
+    if (reason == EMU_STOP_BREAKPOINT) {
+        run_emulator = false;
+        emulator_clear_bp_hit();
+        if (gdb_stub_is_connected()) {
+            gdb_halted = true;
+            gdb_stub_notify_stop(5);
+        }
+        return true;
+    }
+    if (reason == EMU_STOP_WATCHPOINT) {
+        run_emulator = false;
+        uint16_t wa = emulator_wp_hit_addr();
+        int wt = emulator_wp_hit_type();
+        emulator_clear_wp_hit();
+        if (gdb_stub_is_connected()) {
+            gdb_halted = true;
+            gdb_stub_notify_watchpoint(wa, wt);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Paced free-run for up to EMU_SLICE_MS: run whatever the clock says is
+// due, then sleep until the next EMU_PACE_US batch.  A backlog beyond
+// EMU_PACE_LAG_MS (host stall, debugger pause) moves the origin instead of
+// being run flat out.
+static bool run_slice_paced(emu_clock::time_point deadline) {
+    const uint64_t batch = (uint64_t)pace_hz * EMU_PACE_US / 1000000;
+    const uint64_t max_lag = (uint64_t)pace_hz * EMU_PACE_LAG_MS / 1000;
+    emu_stop_reason_t reason;
+    emu_clock::time_point now = emu_clock::now();
+    if (!pace_valid || n8->tick_count < pace_tick0) {
+        pace_t0 = now;
+        pace_tick0 = n8->tick_count;
+        pace_valid = true;
+    }
+    while (now < deadline) {
+        double secs = std::chrono::duration<double>(now - pace_t0).count();
+        uint64_t due = pace_tick0 + (uint64_t)(secs * pace_hz);
+        if (due > n8->tick_count + max_lag) {
+            pace_t0 = now;
+            pace_tick0 = n8->tick_count;
+            due = n8->tick_count + batch;
+        }
+        if (n8->tick_count < due) {
+            emu_input_run(due - n8->tick_count, &reason);
+            emu_rewind_record();
+            if (run_stopped(reason)) return true;
+        }
+        emu_clock::time_point next = pace_t0 + std::chrono::duration_cast<emu_clock::duration>(
+            std::chrono::duration<double>((double)(n8->tick_count + batch - pace_tick0) / pace_hz));
+        std::this_thread::sleep_until(next < deadline ? next : deadline);
+        now = emu_clock::now();
+    }
+    return false;
+}
+
+// Size the next free-run chunk to take about EMU_CHUNK_US at the speed the
+// last full one ran.  Half way there each time, so one slow chunk (a
+// rewind checkpoint, the host busy elsewhere) doesn't collapse it.
+// Breakpoints and watchpoints stop emulator_run() at the instruction
+// either way; the chunk only sets how often the clock is read.
+static void chunk_tune(uint64_t ran, emu_clock::duration took) {
+    const double us = std::chrono::duration<double, std::micro>(took).count();
+    if (ran < chunk_ticks || us <= 0.0) return;
+    const double want = (chunk_ticks + ran / us * EMU_CHUNK_US) / 2;
+    chunk_ticks = (uint64_t)std::max((double)EMU_CHUNK_MIN, std::min((double)EMU_CHUNK_MAX, want));
+}
+
+// Free-run for up to EMU_SLICE_MS.  Returns true if execution stopped.
+static bool run_slice() {
+    emu_clock::time_point now = emu_clock::now();
+    emu_clock::time_point deadline = now + std::chrono::milliseconds(EMU_SLICE_MS);
+    if (pace_hz) return run_slice_paced(deadline);
+    emu_stop_reason_t reason;
+    do {
+        const emu_clock::time_point start = now;
+        const uint64_t ran = emu_input_run(chunk_ticks, &reason);
+        emu_rewind_record();
+        if (run_stopped(reason)) return true;
+        if (emulator_idle() && !emu_input_replaying()) {
+            // Spinning on a quiet device: sleep until input or the slice ends
+            int ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - emu_clock::now()).count();
+            if (ms > 0) tty_wait_input(ms);
+            return false;
+        }
+        now = emu_clock::now();
+        chunk_tune(ran, now - start);
+    } while (now < deadline);
+    return false;
+}
+
+static void emu_thread_func() {
+    while (!emu_quit.load()) {
+        bool changed = drain_commands();
+        changed |= poll_gdb();
+
+        bool running = run_emulator && !gdb_halted;
+        if (running) {
+            changed |= run_slice();
+        } else if (step_emulator && !gdb_halted) {
+            emulator_step();
+            emu_rewind_record();
+            changed = true;
+        }
+        step_emulator = false;
+
+        if (trace_copy_wanted.load(std::memory_order_acquire)) {
+            emu_trace_copy(trace_copy);
+            trace_copy_tick = n8->tick_count;
+            trace_copy_wanted.store(false, std::memory_order_release);
+            changed = true;
+        }
+        if (prof_graph_wanted.load(std::memory_order_acquire)) {
+            if (!emu_prof_graph(prof_graph_copy)) prof_graph_copy = emu_prof_graph_t();
+            prof_graph_wanted.store(false, std::memory_order_release);
+            changed = true;
+        }
+
+        emu_clock::time_point now = emu_clock::now();
+        if (changed || now - last_pub_time >= std::chrono::milliseconds(EMU_PUBLISH_MS)) {
+            publish();
+            if (changed && wake_gui) wake_gui();
+        }
+        if (!running) {
+            pace_valid = false;     // resume paced runs from "now"
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+// ---- Public API ----
+
+void emu_thread_start(const gdb_stub_config_t* gdb_cfg) {
+    static gdb_stub_callbacks_t gdb_cb = {
+        gdb_read_reg8, gdb_read_reg16,
+        gdb_write_reg8, gdb_write_reg16,
+        gdb_read_mem, gdb_write_mem,
+        gdb_step_instruction,
+        gdb_set_breakpoint, gdb_clear_breakpoint,
+        gdb_set_watchpoint, gdb_clear_watchpoint,
+        gdb_get_pc, gdb_get_stop_reason,
+        gdb_reset, gdb_continue_exec, gdb_halt,
+        gdb_reverse_step, gdb_reverse_continue
+    };
+    if (gdb_cfg) gdb_stub_init(&gdb_cb, gdb_cfg);
+    emu_rewind_enable(true);
+
+    emu_quit.store(false);
+    cmd_ring.clear();
+    last_pub_time = emu_clock::now();
+    last_pub_ticks = n8->tick_count;
+    chunk_ticks = EMU_CHUNK_MIN;
+    publish();  // GUI has a valid snapshot before the first frame
+    emu_thread_ptr = new std::thread(emu_thread_func);
+}
+
+void emu_thread_stop() {
+    emu_quit.store(true);
+    if (emu_thread_ptr) {
+        emu_thread_ptr->join();
+        delete emu_thread_ptr;
+        emu_thread_ptr = nullptr;
+    }
+    gdb_stub_shutdown();
+    emu_input_stop();
+    emu_rewind_enable(false);
+    emu_trace_enable(0);
+    emu_prof_enable(false);
+    emu_heat_enable(false);
+    emu_cov_enable(false);
+}
+
+void emu_thread_set_wake(void (*wake)()) {
+    wake_gui = wake;
+}
+
+bool emu_thread_post(emu_cmd_type_t type, uint16_t addr, uint8_t value) {
+    emu_cmd_t cmd;
+    cmd.type = type;
+    cmd.addr = addr;
+    cmd.value = value;
+    cmd.tick = 0;
+    return cmd_ring.push(cmd);
+}
+
+bool emu_thread_seek(uint64_t tick) {
+    emu_cmd_t cmd;
+    cmd.type = EMU_CMD_SEEK;
+    cmd.addr = 0;
+    cmd.value = 0;
+    cmd.tick = tick;
+    return cmd_ring.push(cmd);
+}
+
+bool emu_thread_trace(uint32_t entries) {
+    emu_cmd_t cmd;
+    cmd.type = EMU_CMD_TRACE;
+    cmd.addr = 0;
+    cmd.value = 0;
+    cmd.tick = entries;
+    return cmd_ring.push(cmd);
+}
+
+void emu_thread_trace_request() {
+    trace_copy_wanted.store(true, std::memory_order_release);
+}
+
+const std::vector<emu_trace_entry_t>* emu_thread_trace_copy(uint64_t *tick) {
+    if (trace_copy_wanted.load(std::memory_order_acquire)) return nullptr;
+    if (tick) *tick = trace_copy_tick;
+    return &trace_copy;
+}
+
+void emu_thread_prof_graph_request() {
+    prof_graph_wanted.store(true, std::memory_order_release);
+}
+
+const emu_prof_graph_t* emu_thread_prof_graph() {
+    if (prof_graph_wanted.load(std::memory_order_acquire)) return nullptr;
+    return &prof_graph_copy;
+}
+
+void emu_thread_setbp(char* list) {
+    char *cur = list;
+    uint32_t bp;
+
+    while (*cur) {
+        bp = 0;
+        int offset = my_get_uint(cur, bp);
+        if (offset == 0) return;
+        cur += offset;
+        emu_thread_post(EMU_CMD_BP_SET, (uint16_t)bp);
+    }
+}
+
+uint32_t emu_pace_hz(emu_pace_t pace) {
+    switch (pace) {
+        case EMU_PACE_1MHZ: return 1000000;
+        case EMU_PACE_2MHZ: return 2000000;
+        case EMU_PACE_4MHZ: return 4000000;
+        default:            return 0;
+    }
+}
+
+const emu_snapshot_t* emu_thread_latest() {
+    if (snap_middle.load(std::memory_order_acquire) & SNAP_FRESH) {
+        snap_front = snap_middle.exchange(snap_front, std::memory_order_acq_rel) & SNAP_INDEX;
+    }
+    return &snap_buf[snap_front];
+}
+
+const emu_snapshot_t* emu_thread_snapshot() {
+    return &snap_buf[snap_front];
+}
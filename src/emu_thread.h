@@ -0,0 +1,125 @@
+#pragma once
+
+// Emulation thread: owns the CPU, bus, devices and the GDB stub poll.
+// The GUI talks to it through a lock-free command queue and reads a
+// published state snapshot once per frame.
+
+#include <cstdint>
+#include <vector>
+
+#include "emu_heat.h"
+#include "emu_prof.h"
+#include "emu_trace.h"
+#include "gdb_stub.h"
+
+typedef enum {
+    EMU_CMD_RUN,            // free-run
+    EMU_CMD_PAUSE,          // stop free-running
+    EMU_CMD_STEP,           // single tick (only while paused)
+    EMU_CMD_RESET,          // machine reset (CPU, TTY, ROM)
+    EMU_CMD_BP_ENABLE,      // value: 0/1
+    EMU_CMD_BP_SET,         // addr
+    EMU_CMD_BP_CLEAR,       // addr
+    EMU_CMD_BP_LOG,         // list breakpoints on the console
+    EMU_CMD_FAST,           // value: 0/1, instruction-level fast mode
+    EMU_CMD_PACE,           // value: emu_pace_t
+    EMU_CMD_STEP_BACK,      // back one instruction (only while paused)
+    EMU_CMD_SEEK,           // tick: move to a recorded cycle (pauses)
+    EMU_CMD_TRACE,          // tick: instruction trace entries, 0 = off
+    EMU_CMD_PROF,           // value: emu_prof_cmd_t
+    EMU_CMD_HEAT,           // value: 0/1, memory access counters (from zero)
+    EMU_CMD_COV,            // value: emu_cov_cmd_t
+    EMU_CMD_QUIT
+} emu_cmd_type_t;
+
+typedef enum {
+    EMU_PROF_OFF,
+    EMU_PROF_ON,            // from zero
+    EMU_PROF_CLEAR
+} emu_prof_cmd_t;
+
+typedef enum {
+    EMU_COV_CMD_OFF,
+    EMU_COV_CMD_ON,         // from zero
+    EMU_COV_CMD_CLEAR
+} emu_cov_cmd_t;
+
+// Target clock while free-running.  Paced modes hold tick_count to wall
+// time; unlimited runs as fast as the host allows.
+typedef enum {
+    EMU_PACE_UNLIMITED,
+    EMU_PACE_1MHZ,
+    EMU_PACE_2MHZ,
+    EMU_PACE_4MHZ,
+    EMU_PACE_COUNT
+} emu_pace_t;
+
+typedef struct {
+    emu_cmd_type_t type;
+    uint16_t addr;
+    uint8_t  value;
+    uint64_t tick;
+} emu_cmd_t;
+
+struct emu_snapshot_t {
+    uint8_t  a, x, y, s, p;
+    uint16_t pc;
+    uint16_t ci;                // last instruction address
+    uint64_t pins;              // address/data bus and IRQ line
+    uint64_t tick_count;
+    double   ticks_per_sec;     // measured over the last publish interval
+    uint64_t chunk_ticks;       // free-run ticks between clock checks (tuned)
+    uint32_t target_hz;         // paced clock rate, 0: unlimited
+    bool     running;
+    bool     gdb_halted;
+    bool     gdb_connected;
+    bool     bp_enable;
+    bool     fast;
+    uint64_t history_first;     // recorded cycles reachable by EMU_CMD_SEEK
+    uint64_t history_last;
+    uint32_t trace_capacity;    // instruction trace ring size, 0: off
+    bool     prof_on;
+    uint32_t heat_gen;          // bumped whenever the counters restart from zero
+    uint8_t  mem[1 << 16];
+    uint8_t  dbg_flags[1 << 16];   // DBG_* per address
+    uint32_t prof[1 << 16];        // cycles per address (emu_prof.h), while prof_on
+    bool       heat_on;
+    emu_heat_t heat;               // access counters, while heat_on
+    bool       cov_on;
+    uint8_t    cov[1 << 16];       // EMU_COV_* per address (emu_cov.h), while cov_on
+};
+
+// Lifecycle (call from the GUI thread, after emulator_init())
+void emu_thread_start(const gdb_stub_config_t* gdb_cfg);
+void emu_thread_stop();
+
+// GUI -> emulation.  Returns false if the queue is full.
+bool emu_thread_post(emu_cmd_type_t type, uint16_t addr = 0, uint8_t value = 0);
+void emu_thread_setbp(char* list);   // "$D000 $D005 ..." -> BP_SET per address
+bool emu_thread_seek(uint64_t tick);
+bool emu_thread_trace(uint32_t entries);
+
+// Instruction trace for the GUI: request a copy of the ring, then read it
+// once emu_thread_trace_copy() stops returning nullptr (the emulation
+// thread fills it between slices).  *tick: when it was taken.
+void emu_thread_trace_request();
+const std::vector<emu_trace_entry_t>* emu_thread_trace_copy(uint64_t *tick);
+
+// Call graph, the same way: nullptr until the copy is in (empty while
+// the profiler is off)
+void emu_thread_prof_graph_request();
+const emu_prof_graph_t* emu_thread_prof_graph();
+
+uint32_t emu_pace_hz(emu_pace_t pace);   // 0 for unlimited
+
+// Emulation -> GUI.  emu_thread_latest() picks up the newest published
+// snapshot and should be called once per frame; emu_thread_snapshot()
+// returns that same snapshot for the rest of the frame.
+const emu_snapshot_t* emu_thread_latest();
+const emu_snapshot_t* emu_thread_snapshot();
+
+// Called on the emulation thread after publishing a snapshot that changed
+// for more than time passing (a stop, a command, GDB activity, a copy the
+// GUI asked for), so the GUI can sleep while the CPU is halted.  Must be
+// safe to call from any thread; set before emu_thread_start().
+void emu_thread_set_wake(void (*wake)());
@@ -0,0 +1,114 @@
+// Instruction trace ring, see emu_trace.h.
+
+#include "emu_trace.h"
+#include "n8_machine.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void trace_free(emu_trace_t *t) {
+    delete[] t->tick;
+    delete[] t->pc;
+    delete[] t->a;
+    delete[] t->x;
+    delete[] t->y;
+    delete[] t->s;
+    delete[] t->p;
+    delete[] t->op;
+    delete t;
+}
+
+void emu_trace_enable(uint32_t entries) {
+    if (entries > EMU_TRACE_MAX) entries = EMU_TRACE_MAX;
+    uint32_t cap = 0;
+    if (entries) for (cap = 1; cap < entries; cap <<= 1) {}
+    if (cap == emu_trace_capacity()) return;
+
+    if (n8->trace) trace_free(n8->trace);
+    n8->trace = nullptr;
+    if (!cap) return;
+
+    emu_trace_t *t = new emu_trace_t();
+    t->mask = cap - 1;
+    t->tick = new uint64_t[cap];
+    t->pc = new uint16_t[cap];
+    t->a = new uint8_t[cap];
+    t->x = new uint8_t[cap];
+    t->y = new uint8_t[cap];
+    t->s = new uint8_t[cap];
+    t->p = new uint8_t[cap];
+    t->op = new uint8_t[cap];
+    n8->trace = t;
+}
+
+uint32_t emu_trace_capacity() {
+    return n8->trace ? n8->trace->mask + 1 : 0;
+}
+
+void emu_trace_clear() {
+    if (n8->trace) n8->trace->head = 0;
+}
+
+size_t emu_trace_count() {
+    const emu_trace_t *t = n8->trace;
+    if (!t) return 0;
+    return t->head < (uint64_t)t->mask + 1 ? (size_t)t->head : (size_t)t->mask + 1;
+}
+
+bool emu_trace_get(size_t i, emu_trace_entry_t &e) {
+    const emu_trace_t *t = n8->trace;
+    const size_t count = emu_trace_count();
+    if (i >= count) return false;
+    const uint32_t k = (uint32_t)(t->head - count + i) & t->mask;
+    e.tick = t->tick[k];
+    e.pc = t->pc[k];
+    e.a = t->a[k];
+    e.x = t->x[k];
+    e.y = t->y[k];
+    e.s = t->s[k];
+    e.p = t->p[k];
+    e.op = t->op[k];
+    return true;
+}
+
+void emu_trace_copy(std::vector<emu_trace_entry_t> &out) {
+    const size_t count = emu_trace_count();
+    out.resize(count);
+    for (size_t i = 0; i < count; i++) emu_trace_get(i, out[i]);
+}
+
+// One column: field of every entry, little endian, through a small buffer
+template <typename T, typename F>
+static bool trace_column(FILE *f, const std::vector<emu_trace_entry_t> &entries, F field) {
+    uint8_t buf[4096];
+    size_t n = 0;
+    for (const emu_trace_entry_t &e : entries) {
+        const T v = field(e);
+        for (size_t b = 0; b < sizeof(T); b++) buf[n++] = (uint8_t)(v >> (8 * b));
+        if (n + sizeof(T) > sizeof(buf)) {
+            if (fwrite(buf, 1, n, f) != n) return false;
+            n = 0;
+        }
+    }
+    return fwrite(buf, 1, n, f) == n;
+}
+
+bool emu_trace_save(const char *path, const std::vector<emu_trace_entry_t> &entries) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    uint8_t hdr[16] = { 'N', '8', 'T', 'R', EMU_TRACE_VERSION };
+    const uint64_t count = entries.size();
+    for (int i = 0; i < 8; i++) hdr[8 + i] = (uint8_t)(count >> (8 * i));
+    typedef const emu_trace_entry_t &E;
+    bool ok = fwrite(hdr, 1, sizeof(hdr), f) == sizeof(hdr) &&
+        trace_column<uint64_t>(f, entries, [](E e) { return e.tick; }) &&
+        trace_column<uint16_t>(f, entries, [](E e) { return e.pc; }) &&
+        trace_column<uint8_t>(f, entries, [](E e) { return e.a; }) &&
+        trace_column<uint8_t>(f, entries, [](E e) { return e.x; }) &&
+        trace_column<uint8_t>(f, entries, [](E e) { return e.y; }) &&
+        trace_column<uint8_t>(f, entries, [](E e) { return e.s; }) &&
+        trace_column<uint8_t>(f, entries, [](E e) { return e.p; }) &&
+        trace_column<uint8_t>(f, entries, [](E e) { return e.op; });
+    ok = fclose(f) == 0 && ok;
+    return ok;
+}
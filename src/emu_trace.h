@@ -0,0 +1,68 @@
+#pragma once
+
+// Instruction trace: an opt-in ring holding the last N instructions
+// executed, written on the bus path at each opcode fetch (SYNC cycle).
+// An entry is the state the instruction starts from: tick, PC, A X Y S P
+// and the opcode.
+//
+// The ring is struct-of-arrays, one array per field, so a record is eight
+// plain stores at the same index and a dump writes each column in one go.
+// Cached fast-mode blocks don't pass through the bus, so fast mode runs
+// one instruction at a time while tracing; a skipped idle loop shows up
+// as its last traced pass followed by a jump in tick.
+//
+// Everything acts on the calling thread's machine (N8Machine::trace).
+
+#include "m6502.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define EMU_TRACE_MAX     (1u << 22)   // entries (64 MB of ring)
+#define EMU_TRACE_VERSION 1
+
+struct emu_trace_entry_t {
+    uint64_t tick;
+    uint16_t pc;
+    uint8_t  a, x, y, s, p;
+    uint8_t  op;
+};
+
+struct emu_trace_t {
+    uint32_t  mask = 0;         // capacity - 1, capacity a power of two
+    uint64_t  head = 0;         // entries recorded; newest at (head - 1) & mask
+    uint64_t *tick = nullptr;
+    uint16_t *pc = nullptr;
+    uint8_t  *a = nullptr, *x = nullptr, *y = nullptr, *s = nullptr, *p = nullptr;
+    uint8_t  *op = nullptr;
+};
+
+// Ring of at least entries (rounded up to a power of two, at most
+// EMU_TRACE_MAX); 0 turns tracing off.  Changing the size clears it.
+void     emu_trace_enable(uint32_t entries);
+uint32_t emu_trace_capacity();          // 0 while off
+void     emu_trace_clear();
+size_t   emu_trace_count();             // entries held
+bool     emu_trace_get(size_t i, emu_trace_entry_t &e);     // 0 = oldest
+void     emu_trace_copy(std::vector<emu_trace_entry_t> &out);   // oldest first
+
+// Binary dump, little endian:
+//     "N8TR" version:u8 0:u8[3] count:u64
+//     tick:u64[count] pc:u16[count] a:u8[count] x y s p op (same)
+// oldest entry first in every column.
+bool emu_trace_save(const char *path, const std::vector<emu_trace_entry_t> &entries);
+
+// Bus path, at a SYNC cycle: pc is the opcode's address
+static inline void emu_trace_record(emu_trace_t &t, const m6502_t &cpu, uint64_t tick,
+                                    uint16_t pc, uint8_t op) {
+    const uint32_t i = (uint32_t)t.head++ & t.mask;
+    t.tick[i] = tick;
+    t.pc[i] = pc;
+    t.a[i] = cpu.A;
+    t.x[i] = cpu.X;
+    t.y[i] = cpu.Y;
+    t.s[i] = cpu.S;
+    t.p[i] = cpu.P;
+    t.op[i] = op;
+}
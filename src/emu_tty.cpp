@@ -1,20 +1,43 @@
 
 #include "emu_tty.h"
+#include "emu_input.h"
+#include "emu_ring.h"
+#include "emu_sched.h"
+#include "n8_memory_map.h"
 #include "emulator.h"
+#include "n8_machine.h"
 #include "m6502.h"
 
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <sys/select.h>
+#include <errno.h>
+#include <poll.h>
 #include <termios.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <queue>
+#include <thread>
 using namespace std;
 
 struct termios orig_termios;
-queue<uint8_t> tty_buff;
+
+// Host input: a background reader blocks on the input fd and feeds its
+// machine's tty.rx_ring.  tty_poll() notices it once per emulator_run()
+// batch and books EMU_EV_TTY_RX, which then moves one byte per UART byte
+// time into tty.buff until the ring is empty.  Nothing runs per cycle.
+#define TTY_BYTE_CYCLES 87      // 10 bits at 115200 baud, 1 MHz CPU
+static mutex tty_rx_mutex;                  // only for tty_rx_cv
+static condition_variable tty_rx_cv;        // signalled when input arrives (any machine)
+
+static void tty_rx_notify() {
+    { lock_guard<mutex> lock(tty_rx_mutex); }
+    tty_rx_cv.notify_all();
+}
 
 void tty_reset_term() {
     tcsetattr(0, TCSANOW, &orig_termios);
@@ -32,38 +55,87 @@ void set_conio() {
 }
 
 int tty_kbhit() {
-    struct timeval tv = { 0L, 0L };
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(0, &fds);
-    return select(1, &fds, NULL, NULL, &tv) > 0;
-}
-
-int getch() {
-    int r;
-    unsigned char c;
-    if ((r=read(0, &c, sizeof(c))) < 0) {
-        return r;
-    }
-    return c;
+    return n8->tty.rx_pending.load(memory_order_acquire);
 }
 
-void tty_tick(uint64_t &pins) {
-    if(tty_buff.size() > 0) { 
-        emu_set_irq(1);
+// Blocks in poll() on the input and the stop pipe, so tty_stop_reader()
+// can end it without closing (or waiting on) the input fd
+static void tty_reader(emu_tty_t *tty, int fd, int stop) {
+    struct pollfd fds[2] = { { fd, POLLIN, 0 }, { stop, POLLIN, 0 } };
+    while(1) {
+        if(poll(fds, 2, -1) < 0) {
+            if(errno == EINTR) continue;
+            break;
+        }
+        if(fds[1].revents) break;
+        unsigned char c;
+        ssize_t r = read(fd, &c, sizeof(c));
+        if(r < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        if(r <= 0) break;   // EOF or error: no more input
+        while(!tty->rx_ring.push(c)) {
+            if(poll(&fds[1], 1, 1) != 0) goto done;
+        }
+        tty->rx_pending.store(true, memory_order_release);
+        tty_rx_notify();
     }
-    if(!tty_kbhit()) {
-        return;
+done:
+    tty->reader_running.store(false);
+}
+
+bool tty_wait_input(int timeout_ms) {
+    emu_tty_t &tty = n8->tty;
+    unique_lock<mutex> lock(tty_rx_mutex);
+    tty_rx_cv.wait_for(lock, chrono::milliseconds(timeout_ms), [&tty] {
+        return tty.rx_pending.load();
+    });
+    return tty.rx_pending.load();
+}
+
+void tty_start_reader(int fd) {
+    emu_tty_t &tty = n8->tty;
+    if(tty.reader_running.load()) return;
+    tty_stop_reader();      // one that ran out of input is still to be joined
+    if(pipe(tty.reader_stop) != 0) return;
+    tty.reader_running.store(true);
+    tty.reader = new thread(tty_reader, &tty, fd, tty.reader_stop[0]);
+}
+
+void tty_stop_reader() {
+    emu_tty_t &tty = n8->tty;
+    if(!tty.reader) return;
+    const char quit = 0;
+    if(write(tty.reader_stop[1], &quit, 1) < 0) perror("tty_stop_reader");
+    tty.reader->join();
+    delete tty.reader;
+    tty.reader = nullptr;
+    close(tty.reader_stop[0]);
+    close(tty.reader_stop[1]);
+    tty.reader_stop[0] = tty.reader_stop[1] = -1;
+}
+
+static void tty_rx_event(uint64_t now) {
+    emu_tty_t &tty = n8->tty;
+    uint8_t c;
+    if(!tty.rx_hold && tty.rx_ring.pop(c)) {
+        tty.buff.push(c);
+        emu_set_irq(N8_IRQ_BIT_TTY);
+        emu_input_note(EMU_IN_TTY, 0, c);
+        emu_sched_at(EMU_EV_TTY_RX, now + TTY_BYTE_CYCLES, tty_rx_event);
     }
-    int c;
-    if((c = getch()) < 0) { // error condition
-        exit(-1);
+}
+
+void tty_poll(uint64_t now) {
+    emu_tty_t &tty = n8->tty;
+    if(!tty.rx_hold && tty.rx_pending.load(memory_order_relaxed) &&
+       tty.rx_pending.exchange(false, memory_order_acq_rel) &&
+       !emu_sched_booked(EMU_EV_TTY_RX)) {
+        // Cleared before booking, so a byte pushed meanwhile re-raises it
+        emu_sched_at(EMU_EV_TTY_RX, now + TTY_BYTE_CYCLES, tty_rx_event);
     }
-    tty_buff.push((uint8_t (c & 0xff)));
-    emu_set_irq(1);
 }
 
 void tty_decode(uint64_t &pins, uint8_t dev_reg) {
+    queue<uint8_t> &tty_buff = n8->tty.buff;
     if((pins & M6502_RW)) { // Read
         uint8_t data_bus;
         switch(dev_reg) {
@@ -89,7 +161,7 @@ void tty_decode(uint64_t &pins, uint8_t dev_reg) {
                 data_bus = tty_buff.front();
                 tty_buff.pop();
                 if(tty_buff.size()== 0) {
-                    emu_clr_irq(1);
+                    emu_clr_irq(N8_IRQ_BIT_TTY);
                 }
                 break;
             default:
@@ -118,22 +190,42 @@ void tty_decode(uint64_t &pins, uint8_t dev_reg) {
 
 }
 
+void tty_hold_input(uint8_t who, bool hold) {
+    emu_tty_t &tty = n8->tty;
+    if(hold) tty.rx_hold |= who;
+    else tty.rx_hold &= ~who;
+    if(!tty.rx_hold && !tty.rx_ring.empty()) tty.rx_pending.store(true, memory_order_release);
+}
+
+// Only safe with no reader running, e.g. in a forked child (fork() leaves
+// the reader thread behind)
+void tty_drop_host_input() {
+    emu_tty_t &tty = n8->tty;
+    uint8_t c;
+    while(tty.rx_ring.pop(c)) {}
+    tty.rx_pending.store(false);
+    emu_sched_cancel(EMU_EV_TTY_RX);
+}
+
 void tty_inject_char(uint8_t c) {
-    tty_buff.push(c);
+    n8->tty.buff.push(c);
+    emu_set_irq(N8_IRQ_BIT_TTY);
 }
 int tty_buff_count() {
-    return (int)tty_buff.size();
+    return (int)n8->tty.buff.size();
 }
 
 void tty_reset() {
-    while( !tty_buff.empty()) {
-        tty_buff.pop();
+    while( !n8->tty.buff.empty()) {
+        n8->tty.buff.pop();
     }
-    emu_clr_irq(1);
+    emu_sched_cancel(EMU_EV_TTY_RX);
+    emu_clr_irq(N8_IRQ_BIT_TTY);
     printf("tty_reset():\r\n");
     fflush(stdout);
 }
 
 void tty_init() {
     set_conio();
+    tty_start_reader(0);
 }
@@ -3,12 +3,43 @@
 #pragma once
 #include <stdint.h>
 
+#include <atomic>
+#include <queue>
+#include <thread>
+
+#include "emu_ring.h"
+
+// Who is holding host input back, see tty_hold_input()
+#define TTY_HOLD_REWIND 0x01        // emu_rewind replaying its history
+#define TTY_HOLD_INPUT  0x02        // emu_input replaying a log
+
+// Per-machine TTY state (N8Machine::tty).  Host input reaches a machine
+// through its own reader thread: rx_ring -> (UART byte time) -> buff.
+// The reader holds a pointer into the machine; n8_machine_free() stops it.
+struct emu_tty_t {
+    std::queue<uint8_t>         buff;           // bytes the firmware can read
+    emu_ring_t<uint8_t, 1024>   rx_ring;        // reader thread -> emulation
+    std::atomic<bool>           rx_pending{false};
+    std::atomic<bool>           reader_running{false};
+    std::thread                *reader = nullptr;   // until tty_stop_reader() joins it
+    int                         reader_stop[2] = {-1, -1};  // pipe: a byte asks it to quit
+    uint8_t                     rx_hold = 0;        // TTY_HOLD_*: host bytes wait in rx_ring
+};
+
 void tty_reset_term();
 // void tty_set_conio();
 int tty_kbhit();
+bool tty_wait_input(int timeout_ms);   // block until host input (true) or timeout
 void tty_init();
+void tty_start_reader(int fd);   // feeds the calling thread's machine; tty_init() starts it on stdin
+void tty_stop_reader();          // and waits for it to quit; the fd stays open
 void tty_reset();
-void tty_tick(uint64_t&);
+void tty_poll(uint64_t now);      // pick up host input (books the UART event)
+// Hold host input back (rx_ring keeps it) while recorded input is being
+// replayed; once no one holds it, whatever queued up meanwhile goes through.
+void tty_hold_input(uint8_t who, bool hold);
+// Discard host input not yet in the FIFO (rx_ring and the UART event)
+void tty_drop_host_input();
 void tty_decode(uint64_t&, uint8_t);
 void tty_inject_char(uint8_t);
 int tty_buff_count();
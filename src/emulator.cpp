@@ -1,14 +1,29 @@
 #define CHIPS_IMPL
 #include "m6502.h"
 
+#ifndef N8_HEADLESS
 #include "imgui.h"
+#include "emu_thread.h"
+#endif
 
 #include "emulator.h"
+#include "emu_bus.h"
+#include "emu_fast6502.h"
+#include "emu_input.h"
+#include "emu_irq.h"
+#include "emu_rewind.h"
+#include "emu_sched.h"
+#include "emu_cov.h"
+#include "emu_heat.h"
+#include "emu_prof.h"
+#include "emu_trace.h"
 #include "emu_tty.h"
 #include "emu_labels.h"
 #include "gui_console.h"
 #include "utils.h"
 #include "machine.h"
+#include "n8_memory_map.h"
+#include "n8_machine.h"
 
 #include <stdint.h>
 #include <stdlib.h>
@@ -16,161 +31,382 @@
 
 
 
-#define BUS_DECODE(bus, base, mask) if((bus & mask) == base)
 // #define BUS_LOG(tc,sys,rw,a,d) printf("%lu: %s %s %04X: %02X\r\n",tc,sys,rw ? "R" : "W",a,d);
 #define BUS_LOG(tc,sys,rw,a,d) ;;
 
-#define IRQ_CLR() mem[0x00FF] = 0x00;
-#define IRQ_SET(bit) mem[0x00FF] = (mem[0x00FF] | 0x01 << bit)
 
 const char *rom_file = "N8firmware";
-uint64_t tick_count = 0;
-
-// 64 KB zero-initialized memory
-uint8_t mem[(1<<16)] = { };
-
-m6502_t cpu;
-m6502_desc_t desc;
-uint64_t pins;
-bool bp_enable;
-bool bp_hit = false;
-bool bp_mask[65536] {false};
-bool wp_write_mask[65536] {false};
-bool wp_read_mask[65536] {false};
-static bool wp_enable = false;
-static bool wp_hit_flag = false;
-static uint16_t wp_addr = 0;
-static int wp_type = 0;  // 2=write, 3=read, 4=access
-bool pc_mask[65536] {false};
-bool label_mask[65536] {false};  // TODO: init via .sym file
-uint16_t cur_instruction = 0x00;
+// The GUI/headless machine; other threads may bind their own, see
+// n8_machine.h
+N8Machine n8_default;
+__thread N8Machine *n8 = &n8_default;
 
 // these are the same.
-#define BUS_READ (pins & M6502_RW)
+#define BUS_READ (n8->pins & M6502_RW)
 bool emu_bus_read() {
     return BUS_READ;
 }
-void emu_set_irq(int bit) {
-    IRQ_SET(bit);
+
+
+// ---- Bus page table ----
+//
+// One entry per 256-byte page.  Plain RAM pages have no handler and cost a
+// single indexed load per access.  ROM pages ignore CPU writes (debugger
+// writes via emulator_write_mem still land).  Device space $D800-$DFFF is
+// split further into 32-byte slots, see emulator_map_slot().
+
+
+static void dev_slot_io(uint64_t &pins, uint16_t addr) {
+    const uint16_t offset = addr - N8_DEV_BASE;
+    emu_dev_fn dev = n8->dev_slots[offset / N8_DEV_SLOT_SIZE];
+    if (dev) dev(pins, offset & (N8_DEV_SLOT_SIZE - 1));
+}
+
+// TTY still lives at its legacy 16-byte window in page $C1
+static void legacy_tty_io(uint64_t &pins, uint16_t addr) {
+    if ((addr & 0xFFF0) == N8_LEGACY_TTY_BASE) {
+        tty_decode(pins, addr & 0x000F);
+    }
+}
+
+void emulator_map_page(uint8_t page, emu_bus_fn io, bool rom) {
+    n8->page_table[page].io = io;
+    n8->page_table[page].rom = rom;
+    emu_fast6502_invalidate(page);
+}
+
+void emulator_map_slot(int slot, emu_dev_fn dev) {
+    const int per_page = 256 / N8_DEV_SLOT_SIZE;
+    const int first = slot - slot % per_page;
+    n8->dev_slots[slot] = dev;
+
+    // A device page with no devices left goes back to a plain page
+    bool any = false;
+    for (int s = first; s < first + per_page; s++) any |= n8->dev_slots[s] != nullptr;
+    n8->page_table[(N8_DEV_BASE >> 8) + slot / per_page].io = any ? dev_slot_io : nullptr;
+    emu_fast6502_invalidate((N8_DEV_BASE >> 8) + slot / per_page);
 }
-void emu_clr_irq(int bit) {
-    mem[0x00FF] = (mem[0x00FF] & ~(0x01 << bit) );
+
+void emulator_bus_init() {
+    for (int page = 0; page < 256; page++) {
+        n8->page_table[page].io = nullptr;
+        n8->page_table[page].rom = (page << 8) >= N8_LEGACY_ROM_BASE;
+    }
+    for (size_t slot = 0; slot < sizeof(n8->dev_slots) / sizeof(n8->dev_slots[0]); slot++) {
+        n8->dev_slots[slot] = nullptr;
+    }
+    emu_fast6502_flush();
+    emulator_map_page(N8_LEGACY_TTY_BASE >> 8, legacy_tty_io, false);
+    emulator_map_slot(N8_IRQ_SLOT, emu_irq_dev);
 }
 
 void emulator_loadrom() {
     uint16_t rom_ptr = 0xD000;
     printf("Loading ROM\r\n");fflush(stdout);
     FILE *fp = fopen(rom_file, "r");
+    if(!fp) {printf("ERROR rom load: %s\r\n", rom_file); fflush(stdout);exit(-1);}
     while(1) {
         uint8_t c = fgetc(fp);
         if(feof(fp)) break;
-        mem[rom_ptr] = c;
+        n8->mem[rom_ptr] = c;
+        MEM_TOUCH(*n8, rom_ptr);
         rom_ptr++;  
     }
     fclose(fp);
+    emu_fast6502_flush();
+}
+void emulator_set_rom_file(const char *file) {
+    rom_file = file;
 }
 void emulator_init() {
+    emu_sched_init();
+    emu_irq_reset();
+    emulator_bus_init();
     emulator_loadrom();
     emu_labels_init();
     
-    pins = m6502_init(&cpu, &desc);
+    n8->pins = m6502_init(&n8->cpu, &n8->desc);
     tty_init();
     
 }
 
-void emulator_step() {
+// ---- Machine instances ----
+
+N8Machine *n8_machine_new() {
+    N8Machine *m = new N8Machine();
+    N8Machine *prev = n8_machine_bind(m);
+    emu_sched_init();
+    emulator_bus_init();
+    m->pins = m6502_init(&m->cpu, &m->desc);
+    n8_machine_bind(prev);
+    return m;
+}
+
+void n8_machine_free(N8Machine *m) {
+    if (!m || m == &n8_default) return;
+    N8Machine *prev = n8_machine_bind(m);
+    tty_stop_reader();          // it writes into m->tty
+    emu_fast6502_flush();       // cached blocks are heap allocated
+    emu_rewind_free();
+    emu_input_stop();
+    emu_trace_enable(0);
+    emu_prof_enable(false);
+    emu_heat_enable(false);
+    emu_cov_enable(false);
+    n8_machine_bind(prev == m ? nullptr : prev);
+    delete m;
+}
+
+N8Machine *n8_machine_bind(N8Machine *m) {
+    N8Machine *prev = n8;
+    n8 = m ? m : &n8_default;
+    return prev;
+}
+
+// Everything that happens on the bus after the CPU has driven its pins for
+// one cycle: debug checks, IRQ line, memory/device access.
+static void emulator_bus_cycle(N8Machine &m) {
         char debug_msg[256];
-        pins = m6502_tick(&cpu, pins);
-        const uint16_t addr = M6502_GET_ADDR(pins);
+        const uint16_t addr = M6502_GET_ADDR(m.pins);
 
-        if(addr == m6502_pc(&cpu)) {
+        if(addr == m6502_pc(&m.cpu)) {
             // printf("ci_next\r\n");fflush(stdout);
-            cur_instruction = m6502_pc(&cpu);
+            m.cur_instruction = m6502_pc(&m.cpu);
         }
 
-        if(bp_enable && bp_mask[addr] && (pins & M6502_SYNC)) {
-            bp_hit = true;
-            snprintf(debug_msg, 256, "BP Hit: %4.4x (%d)\r\n", addr, addr);
-            gui_con_printmsg(debug_msg);
-
-        }
-        if (wp_enable) {
-            bool is_write = !(pins & M6502_RW);
-            if ((wp_write_mask[addr] && is_write) ||
-                (wp_read_mask[addr] && (pins & M6502_RW) && !(pins & M6502_SYNC))) {
-                if (!wp_hit_flag) {
-                    wp_hit_flag = true;
-                    wp_addr = addr;
-                    wp_type = is_write ? 2 : 3;
-                    // If both masks set at this addr, this is an access watchpoint (Z4)
-                    if (wp_write_mask[addr] && wp_read_mask[addr]) wp_type = 4;
+        if(DBG_PAGE_ARMED(m, addr)) {
+            const uint8_t dbg = m.dbg_flags[addr];
+            if(m.bp_enable && (dbg & DBG_EXEC) && (m.pins & M6502_SYNC)) {
+                m.bp_hit = true;
+                if(!m.dbg_quiet) {
+                    snprintf(debug_msg, 256, "BP Hit: %4.4x (%d)\r\n", addr, addr);
+                    gui_con_printmsg(debug_msg);
+                }
+            }
+            if (m.wp_enable) {
+                bool is_write = !(m.pins & M6502_RW);
+                if (((dbg & DBG_WRITE) && is_write) ||
+                    ((dbg & DBG_READ) && (m.pins & M6502_RW) && !(m.pins & M6502_SYNC))) {
+                    if (!m.wp_hit_flag) {
+                        m.wp_hit_flag = true;
+                        m.wp_addr = addr;
+                        m.wp_type = is_write ? 2 : 3;
+                        // If both flags set at this addr, this is an access watchpoint (Z4)
+                        if ((dbg & DBG_WRITE) && (dbg & DBG_READ)) m.wp_type = 4;
+                    }
                 }
             }
         }
-        IRQ_CLR();
-        // pins = pins & ~M6502_IRQ;
-
-        tty_tick(pins);
-        // pins & M6502_IRQ ==  M6502_IRQ
-        if(mem[0x00FF] == 0) {
-            pins = pins & ~M6502_IRQ;
-            // pins = pins | M6502_IRQ; // pull up
-            // printf("IRQ is set: %d %d\r\n", mem[0x00FF],pins & M6502_IRQ ==  M6502_IRQ);
-            // printf("PC: %4.4x\r\n", m6502_pc(&cpu));
-            // printf("P: 0x%2.2x\r\n", m6502_p(&cpu));
-            // fflush(stdout);
+        // Device events due this cycle (UART byte time, ...), emu_sched_poll()
+        if (m.tick_count >= m.sched.due) emu_sched_run(m.tick_count);
+
+        // Backing store first, then the page's device (if any) may
+        // override the data bus or act on the write.
+        const emu_page_t &page = m.page_table[addr >> 8];
+        if (m.pins & M6502_RW) {
+            M6502_SET_DATA(m.pins, m.mem[addr]);
         }
         else {
-            // pins = pins & ~M6502_IRQ;
-            pins = pins | M6502_IRQ; // pull up
-            // printf("IRQ is clear\r\n");
-            // fflush(stdout);
+            m.cpu_writes++;
+            if (!page.rom) {
+                m.mem[addr] = M6502_GET_DATA(m.pins);
+                MEM_TOUCH(m, addr);
+                // printf("%04X: %02X\n", addr, m.mem[addr]);
+            }
         }
-
-        // Write to underlying RAM first
-        if (BUS_READ) {
-            M6502_SET_DATA(pins, mem[addr]);
+        if (page.io) {
+            page.io(m.pins, addr);
         }
-        else {
-            mem[addr] = M6502_GET_DATA(pins);
-            // printf("%04X: %02X\n", addr, mem[addr]);
+        if (m.heat) emu_heat_count(*m.heat, addr, m.pins & M6502_RW, m.pins & M6502_SYNC);
+        if (m.pins & M6502_SYNC) {
+            if (m.trace) emu_trace_record(*m.trace, m.cpu, m.tick_count, addr, M6502_GET_DATA(m.pins));
+            if (m.prof) emu_prof_charge(*m.prof, addr, M6502_GET_DATA(m.pins), m.cpu.S, m.tick_count);
+            if (m.cov) emu_cov_fetch(*m.cov, addr, M6502_GET_DATA(m.pins), m.mem[(uint16_t)(addr + 1)]);
         }
+        
+        m.tick_count++;
 
-        // Monitor Zeropage
-        BUS_DECODE(addr, 0x0000, 0xFF00) {
-            // BUS_LOG(tick_count, "0Pg", BUS_READ, addr, mem[addr] );
+}
+
+static inline void machine_step(N8Machine &m) {
+    m.pins = m6502_tick(&m.cpu, m.pins);
+    emulator_bus_cycle(m);
+}
+
+void emulator_step() {
+    machine_step(*n8);
+}
+
+// True at a SYNC boundary the fast interpreter may take over from: no
+// interrupt or reset about to be serviced, and no heatmap (it counts
+// every bus cycle, the fast interpreter only shows the opcode fetch).
+static bool emulator_fast_ready(const N8Machine &m) {
+    if (!(m.pins & M6502_SYNC) || m.heat) return false;
+    if (m.pins & (M6502_RES | M6502_RDY)) return false;
+    if (m.cpu.brk_flags || m.cpu.irq_pip || m.cpu.nmi_pip) return false;
+    if ((m.pins & M6502_IRQ) && !(m.cpu.P & M6502_IF)) return false;
+    if ((m.pins & ~m.cpu.PINS) & M6502_NMI) return false;
+    return true;
+}
+
+// The last cycle of a fast instruction/block is the next opcode fetch; run
+// it through the normal bus path so breakpoints, the IRQ line and devices
+// see it as usual.
+static void emulator_fast_finish(N8Machine &m, int cycles) {
+    m.tick_count += cycles - 1;
+    m.pins = (m.pins & (M6502_IRQ | M6502_NMI)) | M6502_SYNC | M6502_RW;
+    M6502_SET_ADDR(m.pins, m.cpu.PC);
+    m.cpu.PINS = m.pins;
+    emulator_bus_cycle(m);
+}
+
+// Run the whole instruction at the current SYNC boundary through the fast
+// interpreter.  Returns false, with nothing changed, if it has to go
+// through the tick core instead: not at a boundary, interrupt/reset
+// pending, or an instruction emu_fast6502_exec() declines.
+bool emulator_fast_step() {
+    N8Machine &m = *n8;
+    if (!emulator_fast_ready(m)) return false;
+
+    const int cycles = emu_fast6502_exec(&m.cpu);
+    if (!cycles) return false;
+    emulator_fast_finish(m, cycles);
+    return true;
+}
+
+// As emulator_fast_step(), but prefers running cached basic blocks.  budget
+// is the number of cycles left before the caller's stop point.
+static bool emulator_fast_run(N8Machine &m, uint64_t budget) {
+    if (!emulator_fast_ready(m)) return false;
+
+    // Blocks skip the bus between instructions: not while tracing/profiling
+    int cycles = (m.trace || m.prof) ? 0 : emu_fast6502_block(&m.cpu, budget);
+    if (!cycles && budget >= 8) cycles = emu_fast6502_exec(&m.cpu);
+    if (!cycles) return false;
+    emulator_fast_finish(m, cycles);
+    return true;
+}
+
+void emulator_enablefast(bool en) { n8->fast_enable = en; }
+bool emulator_fast_enabled()     { return n8->fast_enable; }
+
+// Nothing outside the CPU can change what a read returns: no interrupt
+// line up and no TTY input waiting (on either side of the reader thread).
+// Timed device activity is bounded separately by the scheduler deadline.
+static bool emulator_devices_quiet() {
+    return !(n8->pins & (M6502_IRQ | M6502_NMI)) && tty_buff_count() == 0 && !tty_kbhit();
+}
+
+static void idle_mark() {
+    N8Machine &m = *n8;
+    m.idle.a = m.cpu.A; m.idle.x = m.cpu.X; m.idle.y = m.cpu.Y; m.idle.s = m.cpu.S; m.idle.p = m.cpu.P;
+    m.idle.writes = m.cpu_writes;
+    m.idle.tick = m.tick_count;
+    m.idle.quiet = emulator_devices_quiet();
+}
+
+// Called at instruction boundaries.  The target of each backward jump is
+// watched as a loop head.  Arriving there again with the same registers,
+// no CPU writes in between (no stores, pushes or interrupts) and quiet
+// devices means the pass read the same values and will keep doing so, so
+// every further pass is identical: skip whole passes up to end or the
+// next device event, whichever is first.  A spin
+// on a status register or on a RAM flag set by an IRQ handler both fit.
+static void emulator_idle_check(uint64_t end) {
+    N8Machine &m = *n8;
+    const uint16_t pc = m.cpu.PC;
+    if (pc == m.idle.head) {
+        if (m.idle.quiet && m.idle.writes == m.cpu_writes &&
+            m.idle.a == m.cpu.A && m.idle.x == m.cpu.X && m.idle.y == m.cpu.Y &&
+            m.idle.s == m.cpu.S && m.idle.p == m.cpu.P && emulator_devices_quiet()) {
+            const uint64_t period = m.tick_count - m.idle.tick;
+            const uint64_t until = end < m.sched.due ? end : m.sched.due;
+            const uint64_t passes = (period && m.tick_count < until) ? (until - m.tick_count) / period : 0;
+            if (passes) {
+                m.tick_count += passes * period;
+                m.idle_hit = true;
+            }
         }
+        idle_mark();
+    }
+    else if (pc < m.idle.prev) {
+        m.idle.head = pc;
+        idle_mark();
+    }
+    m.idle.prev = pc;
+}
+
+void emulator_idle_reset() {
+    n8->idle.head = 0;
+    n8->idle.prev = 0;
+    n8->idle.writes = n8->cpu_writes - 1;   // never matches until re-marked
+}
 
-        // Handle some devices
-        BUS_DECODE(addr, 0xFFF0, 0xFFF0) {
-            BUS_LOG(tick_count, "VEC", BUS_READ, addr, mem[addr] );
+void emulator_enableidle(bool en) { n8->idle_enable = en; emulator_idle_reset(); }
+bool emulator_idle_enabled()      { return n8->idle_enable; }
+bool emulator_idle()              { return n8->idle_hit; }
+// Batched run loop: tick until max_cycles elapse or a breakpoint/watchpoint
+// fires.  Hit flags are left set for the caller, same as emulator_step().
+uint64_t emulator_run(uint64_t max_cycles, emu_stop_reason_t *stop_reason) {
+    N8Machine &m = *n8;
+    emu_stop_reason_t reason = EMU_STOP_CYCLES;
+    uint64_t start = m.tick_count;
+    const uint64_t end = start + max_cycles;
+    m.idle_hit = false;
+    tty_poll(m.tick_count);
+
+    while(m.tick_count < end) {
+        // Fast paths never run past end or the next device event; the
+        // remainder runs on the tick core
+        const uint64_t until = end < m.sched.due ? end : m.sched.due;
+        if(!(m.fast_enable && m.tick_count < until && emulator_fast_run(m, until - m.tick_count))) {
+            machine_step(m);
         }
-        // TTY device
-        BUS_DECODE(addr, 0xC100, 0xFFF0) { 
-            const uint8_t dev_reg = (addr - 0xC100) & 0x00FF;
-            tty_decode(pins, dev_reg);
+        if(m.idle_enable && (m.pins & M6502_SYNC)) {
+            emulator_idle_check(end);
         }
-        // IRQ handling
-        
-        tick_count++;
+        if(m.bp_enable && m.bp_hit) {
+            reason = EMU_STOP_BREAKPOINT;
+            break;
+        }
+        if(m.wp_enable && m.wp_hit_flag) {
+            reason = EMU_STOP_WATCHPOINT;
+            break;
+        }
+    }
+    if(stop_reason) *stop_reason = reason;
+    return m.tick_count - start;
+}
 
+uint64_t emulator_ticks() {
+    return n8->tick_count;
 }
+
+void emulator_write_mem(uint16_t addr, uint8_t val) {
+    n8->mem[addr] = val;
+    MEM_TOUCH(*n8, addr);
+    emulator_idle_reset();
+}
+uint32_t emulator_mem_epoch() {
+    return n8->mem_gen++;
+}
+
 uint16_t emulator_getci() {
-    return cur_instruction;
+    return n8->cur_instruction;
 }
 uint16_t emulator_getpc() {
-    return m6502_pc(&cpu);
+    return m6502_pc(&n8->cpu);
 }
 
 bool emulator_check_break() {
-    if(bp_enable && bp_hit) {
-        bp_hit = false;
+    if(n8->bp_enable && n8->bp_hit) {
+        n8->bp_hit = false;
         return true;
     }
     return false;
 }
 void emulator_enablebp(bool en) {
-    bp_enable = en;
+    n8->bp_enable = en;
 }
 
 void emulator_logbp() {
@@ -178,7 +414,7 @@ void emulator_logbp() {
 
     int addr = 0;
     while(addr < 65536) {
-        if(bp_mask[addr]) {
+        if(n8->dbg_flags[addr] & DBG_EXEC) {
             snprintf(debug_msg, 256, "  BP: %4.4x (%d)", addr, addr);
             gui_con_printmsg(debug_msg);
         }
@@ -187,12 +423,11 @@ void emulator_logbp() {
 }
 void emulator_setbp(char * buff) {
     char *cur = buff;
-    char debug_msg[256] {0};
 
     uint32_t bp;
     
     // // Clear the mask
-    // for(int i = 0; i<65536; i++) bp_mask[i] = false;
+    // emulator_dbg_clear_all(DBG_EXEC);
 
     while(*cur) {
         bp = 0;
@@ -201,14 +436,17 @@ void emulator_setbp(char * buff) {
         if(offset == 0) return;
         cur += offset;
 
-        uint16_t addr = (uint16_t) bp;
-        bp_mask[addr] = true;
-
-        snprintf(debug_msg, 256, "Set BP: %4.4x (%d)\r\n", bp, bp);
-        gui_con_printmsg(debug_msg);
+        emulator_setbp_addr((uint16_t) bp);
     }
 
 }
+void emulator_setbp_addr(uint16_t addr) {
+    char debug_msg[256] {0};
+
+    emulator_dbg_set(addr, DBG_EXEC);
+    snprintf(debug_msg, 256, "Set BP: %4.4x (%d)\r\n", addr, addr);
+    gui_con_printmsg(debug_msg);
+}
 void emulator_setbp_old(char * buff) {
     char *cur = buff;
     char debug_msg[256] {0};
@@ -218,7 +456,7 @@ void emulator_setbp_old(char * buff) {
     int bp;
     
     // Clear the mask
-    for(int i = 0; i<65536; i++) bp_mask[i] = false;
+    emulator_dbg_clear_all(DBG_EXEC);
 
     while(*cur) {
         bp = 0;
@@ -254,7 +492,7 @@ void emulator_setbp_old(char * buff) {
         if(type >= 0) {
             // bp should contain full address
             uint16_t addr = (uint16_t) bp;
-            bp_mask[addr] = true;
+            emulator_dbg_set(addr, DBG_EXEC);
             snprintf(debug_msg, 256, "PARSED type %d BREAK POINT: %4.4x (%d)\r\n",type , bp, bp);
             gui_con_printmsg(debug_msg);
         }
@@ -263,47 +501,91 @@ void emulator_setbp_old(char * buff) {
 
 }
 
-void emulator_reset() {
-    pins = pins | M6502_RES;
+// ---- Debug flags ----
+
+static void dbg_update_page(uint8_t page) {
+    const uint8_t *f = &n8->dbg_flags[page << 8];
+    bool armed = false;
+    for (int i = 0; i < 256 && !armed; i++) armed = (f[i] & DBG_ARMED) != 0;
+    if (armed) n8->dbg_pages[page >> 6] |= 1ull << (page & 63);
+    else       n8->dbg_pages[page >> 6] &= ~(1ull << (page & 63));
+}
+
+void emulator_dbg_set(uint16_t addr, uint8_t flags) {
+    n8->dbg_flags[addr] |= flags;
+    if (flags & DBG_ARMED) n8->dbg_pages[addr >> 14] |= 1ull << ((addr >> 8) & 63);
+}
+
+void emulator_dbg_clear(uint16_t addr, uint8_t flags) {
+    n8->dbg_flags[addr] &= ~flags;
+    if (DBG_PAGE_ARMED(*n8, addr)) dbg_update_page(addr >> 8);
+}
+
+void emulator_dbg_clear_all(uint8_t flags) {
+    for (int addr = 0; addr < 65536; addr++) n8->dbg_flags[addr] &= ~flags;
+    for (int page = 0; page < 256; page++) dbg_update_page(page);
+}
+
+bool emulator_dbg_any(uint8_t flags) {
+    for (int page = 0; page < 256; page++) {
+        if (!DBG_PAGE_ARMED(*n8, page << 8)) continue;
+        const uint8_t *f = &n8->dbg_flags[page << 8];
+        for (int i = 0; i < 256; i++) {
+            if (f[i] & flags) return true;
+        }
+    }
+    return false;
+}
+
+// Machine half of a reset (CPU, devices, ROM) -- safe to run on the emulation
+// thread.  Symbols are owned by whoever draws them, see emulator_reset().
+void emulator_reset_machine() {
+    n8->pins = n8->pins | M6502_RES;
     tty_reset();
     emulator_loadrom();
+    emulator_idle_reset();
+}
+
+void emulator_reset() {
+    emulator_reset_machine();
     emu_labels_init();
 
 }
 
 // ---- GDB stub accessor functions ----
 
-uint8_t emulator_read_a()  { return m6502_a(&cpu); }
-uint8_t emulator_read_x()  { return m6502_x(&cpu); }
-uint8_t emulator_read_y()  { return m6502_y(&cpu); }
-uint8_t emulator_read_s()  { return m6502_s(&cpu); }
-uint8_t emulator_read_p()  { return m6502_p(&cpu); }
+uint8_t emulator_read_a()  { return m6502_a(&n8->cpu); }
+uint8_t emulator_read_x()  { return m6502_x(&n8->cpu); }
+uint8_t emulator_read_y()  { return m6502_y(&n8->cpu); }
+uint8_t emulator_read_s()  { return m6502_s(&n8->cpu); }
+uint8_t emulator_read_p()  { return m6502_p(&n8->cpu); }
 
-void emulator_write_a(uint8_t v) { m6502_set_a(&cpu, v); }
-void emulator_write_x(uint8_t v) { m6502_set_x(&cpu, v); }
-void emulator_write_y(uint8_t v) { m6502_set_y(&cpu, v); }
-void emulator_write_s(uint8_t v) { m6502_set_s(&cpu, v); }
-void emulator_write_p(uint8_t v) { m6502_set_p(&cpu, v); }
+void emulator_write_a(uint8_t v) { m6502_set_a(&n8->cpu, v); }
+void emulator_write_x(uint8_t v) { m6502_set_x(&n8->cpu, v); }
+void emulator_write_y(uint8_t v) { m6502_set_y(&n8->cpu, v); }
+void emulator_write_s(uint8_t v) { m6502_set_s(&n8->cpu, v); }
+void emulator_write_p(uint8_t v) { m6502_set_p(&n8->cpu, v); }
 
 void emulator_write_pc(uint16_t addr) {
-    pins = (pins & (M6502_IRQ | M6502_NMI | M6502_RES | M6502_RDY)) | M6502_SYNC | M6502_RW;
-    M6502_SET_ADDR(pins, addr);
-    M6502_SET_DATA(pins, mem[addr]);
-    m6502_set_pc(&cpu, addr);
+    n8->pins = (n8->pins & (M6502_IRQ | M6502_NMI | M6502_RES | M6502_RDY)) | M6502_SYNC | M6502_RW;
+    M6502_SET_ADDR(n8->pins, addr);
+    M6502_SET_DATA(n8->pins, n8->mem[addr]);
+    m6502_set_pc(&n8->cpu, addr);
 }
 
-bool emulator_bp_hit()      { return bp_enable && bp_hit; }
-void emulator_clear_bp_hit() { bp_hit = false; }
-bool emulator_bp_enabled()   { return bp_enable; }
+bool emulator_bp_hit()      { return n8->bp_enable && n8->bp_hit; }
+void emulator_clear_bp_hit() { n8->bp_hit = false; }
+bool emulator_bp_enabled()   { return n8->bp_enable; }
 
-void emulator_enablewp(bool en) { wp_enable = en; }
-bool emulator_wp_enabled()      { return wp_enable; }
-bool emulator_wp_hit()          { return wp_enable && wp_hit_flag; }
-void emulator_clear_wp_hit()    { wp_hit_flag = false; }
-uint16_t emulator_wp_hit_addr() { return wp_addr; }
-int emulator_wp_hit_type()      { return wp_type; }
+void emulator_enablewp(bool en) { n8->wp_enable = en; }
+bool emulator_wp_enabled()      { return n8->wp_enable; }
+bool emulator_wp_hit()          { return n8->wp_enable && n8->wp_hit_flag; }
+void emulator_clear_wp_hit()    { n8->wp_hit_flag = false; }
+uint16_t emulator_wp_hit_addr() { return n8->wp_addr; }
+int emulator_wp_hit_type()      { return n8->wp_type; }
 
-void emulator_show_memdump_window(bool &show_memmap_window) {
+#ifndef N8_HEADLESS
+void emulator_show_memdump_window(bool &show_memmap_window, const emu_snapshot_t &snap) {
     static bool update_mem_dump = false;
     int line_len = 0x10;
     const int row_size = ((3 * line_len) + 9);
@@ -344,7 +626,7 @@ void emulator_show_memdump_window(bool &show_memmap_window) {
                 char* line_cur = line;
 
                 for(int i = 0; i<line_len && start_addr+i <= end_addr; i++) {
-                    my_itoa(line_cur, mem[start_addr+i],2);
+                    my_itoa(line_cur, snap.mem[(uint16_t)(start_addr+i)],2);
                     line_cur++;line_cur++;
                     *line_cur = ' ';
                     line_cur++;
@@ -364,28 +646,32 @@ void emulator_show_memdump_window(bool &show_memmap_window) {
 }
 
 
-#define sr_bit(bit) (0x01 & (m6502_p(&cpu) >> bit))
+#define sr_bit(bit) (0x01 & (snap.p >> bit))
 
-void emulator_show_status_window(bool &show_status_window, float frame_time, float fps ) {
+void emulator_show_status_window(bool &show_status_window, float frame_time, float fps, const emu_snapshot_t &snap) {
     float val_off=30, lab_off=70;
     ImGui::Begin("CPU Registers", &show_status_window);   // Pass a pointer to our bool variable (the window will have a closing button that will clear the bool when clicked)
     ImGui::Text("A:"); 
-    ImGui::SameLine(val_off); ImGui::Text("%2.2x",m6502_a(&cpu));
+    ImGui::SameLine(val_off); ImGui::Text("%2.2x",snap.a);
     ImGui::SameLine(lab_off); ImGui::Text("X:");
-    ImGui::SameLine(lab_off+val_off); ImGui::Text("%2.2x", m6502_x(&cpu));
+    ImGui::SameLine(lab_off+val_off); ImGui::Text("%2.2x", snap.x);
     ImGui::SameLine(2.0 * lab_off); ImGui::Text("Y:");
-    ImGui::SameLine(2.0 * lab_off + val_off); ImGui::Text("%2.2x",m6502_y(&cpu));
+    ImGui::SameLine(2.0 * lab_off + val_off); ImGui::Text("%2.2x",snap.y);
 
     ImGui::Text("SR:");
     ImGui::SameLine(lab_off); ImGui::Text("N%d V%d -%d B%d D%d I%d Z%d C%d",sr_bit(7),sr_bit(6),sr_bit(5),sr_bit(4), \
                                                     sr_bit(3),sr_bit(2),sr_bit(1),sr_bit(0));
 
-    ImGui::Text("Data: %2.2x     Bu Addr: %4.4x", M6502_GET_DATA(pins), M6502_GET_ADDR(pins));
-    ImGui::Text("  SP: %2.2x        PC: %4.4x",m6502_s(&cpu),m6502_pc(&cpu));
+    ImGui::Text("Data: %2.2x     Bu Addr: %4.4x", M6502_GET_DATA(snap.pins), M6502_GET_ADDR(snap.pins));
+    ImGui::Text("  SP: %2.2x        PC: %4.4x",snap.s,snap.pc);
     // ImGui::Text(" IRQ: %2d %2d ", (pins & M6502_IRQ) == M6502_IRQ, (int) (mem[0x00FF] != 0));
-    ImGui::Text(" IRQ: %2d %2d Last PC: %4.4x", (pins & M6502_IRQ) == M6502_IRQ, (int) (mem[0x00FF] != 0), cur_instruction);
+    ImGui::Text(" IRQ: %2d %2d Last PC: %4.4x", (snap.pins & M6502_IRQ) == M6502_IRQ, (int) (snap.mem[N8_IRQ_FLAGS] != 0), snap.ci);
     ImGui::Text("App avg %.3f ms/frame (%.1f FPS)", frame_time, fps);
-    ImGui::Text("Ticks: %lu", tick_count);
+    ImGui::Text("Ticks: %lu", snap.tick_count);
+    if (snap.target_hz)
+        ImGui::Text("Clock: %.3f / %.3f MHz", snap.ticks_per_sec / 1e6, snap.target_hz / 1e6);
+    else
+        ImGui::Text("Clock: %.3f MHz (unlimited)", snap.ticks_per_sec / 1e6);
     // if (ImGui::Button("Close Me"))
     //     show_status_window = false;
     ImGui::End();
@@ -395,5 +681,4 @@ void emulator_show_status_window(bool &show_status_window, float frame_time, flo
 void emulator_show_console_window(bool &show_console_window) {
     gui_show_console_window(show_console_window);
 }
-
-
+#endif // N8_HEADLESS
@@ -6,23 +6,80 @@
 
 // #include "m6502.h"
 
-extern uint8_t mem[];
-extern bool bp_mask[];
-extern bool wp_write_mask[];
-extern bool wp_read_mask[];
+struct emu_snapshot_t;  // emu_thread.h
 
+// Machine state (memory, CPU, debug flags, ...) lives in N8Machine, see
+// n8_machine.h.  Everything here acts on the calling thread's machine.
+
+// Per-address debug flags (coverage is kept by emu_cov.h, not here)
+#define DBG_EXEC    0x01    // execution breakpoint
+#define DBG_READ    0x02    // read watchpoint
+#define DBG_WRITE   0x04    // write watchpoint
+#define DBG_ARMED   (DBG_EXEC | DBG_READ | DBG_WRITE)
+
+void emulator_dbg_set(uint16_t addr, uint8_t flags);
+void emulator_dbg_clear(uint16_t addr, uint8_t flags);
+void emulator_dbg_clear_all(uint8_t flags);
+bool emulator_dbg_any(uint8_t flags);
+
+typedef enum {
+    EMU_STOP_CYCLES,        // max_cycles elapsed
+    EMU_STOP_BREAKPOINT,    // exec breakpoint hit (bp enabled)
+    EMU_STOP_WATCHPOINT     // read/write watchpoint hit (wp enabled)
+} emu_stop_reason_t;
+
+// Bus dispatch.  An io handler sees the whole address; a slot device in
+// $D800-$DFFF sees its 0-31 register offset.  Read handlers put their
+// value on the data bus with M6502_SET_DATA.
+typedef void (*emu_bus_fn)(uint64_t &pins, uint16_t addr);
+typedef void (*emu_dev_fn)(uint64_t &pins, uint8_t reg);
+
+void emulator_bus_init();
+void emulator_map_page(uint8_t page, emu_bus_fn io, bool rom);
+void emulator_map_slot(int slot, emu_dev_fn dev);   // slot = (addr - $D800) >> 5
+
+void emulator_set_rom_file(const char *file);
+void emulator_loadrom();
 void emulator_init();
 void emulator_step();
+uint64_t emulator_run(uint64_t max_cycles, emu_stop_reason_t *stop_reason);
+uint64_t emulator_ticks();
+
+// Fast mode: emulator_run() executes whole instructions at a time where it
+// can (plain RAM/ROM, no pending interrupt) and ticks the core elsewhere.
+void emulator_enablefast(bool en);
+bool emulator_fast_enabled();
+bool emulator_fast_step();      // one instruction; false = needs the tick core
+
+// Idle-loop skipping (on by default): when the CPU spins in a loop that
+// cannot change anything until a device or interrupt does, emulator_run()
+// advances tick_count over the remaining passes instead of running them.
+// emulator_idle() reports whether the last emulator_run() did so.
+void emulator_enableidle(bool en);
+bool emulator_idle_enabled();
+bool emulator_idle();
+void emulator_idle_reset();     // CPU state/memory changed behind its back
+
+// Debugger-side memory write (stamps the page as written)
+void emulator_write_mem(uint16_t addr, uint8_t val);
+
+// Page write generations: n8->mem_page_gen[page] >= since  <=>  written
+// since.  emulator_mem_epoch() returns the current generation and starts a
+// new one.
+uint32_t emulator_mem_epoch();
+
 void emulator_reset();
+void emulator_reset_machine();
 void emulator_enablebp(bool);
 void emulator_logbp();
 void emulator_setbp(char*);
+void emulator_setbp_addr(uint16_t addr);
 bool emulator_check_break();
 uint16_t emulator_getpc();
 uint16_t emulator_getci();
 
-void emulator_show_memdump_window(bool &);
-void emulator_show_status_window(bool &,float,float);
+void emulator_show_memdump_window(bool &, const emu_snapshot_t &);
+void emulator_show_status_window(bool &,float,float, const emu_snapshot_t &);
 void emulator_show_console_window(bool &);
 bool emu_bus_read();
 void emu_set_irq(int);
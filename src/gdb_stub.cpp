@@ -376,6 +376,32 @@ static std::string handle_continue(const char* data) {
     return "";  // no immediate reply for continue (async)
 }
 
+static std::string watch_stop_reply(uint16_t addr, int type) {
+    const char* wp_type_str = (type == 2) ? "watch" :
+                              (type == 3) ? "rwatch" : "awatch";
+    return "T05" + std::string(wp_type_str) + ":" + to_hex_le16(addr) + ";thread:01;";
+}
+
+// bs / bc: run backwards through the recorded history.  Reaching its start
+// stops with "replaylog:begin", as GDB expects from a replay target.
+static std::string handle_reverse(const char* data) {
+    if (!cb) return "E01";
+    if (strcmp(data, "s") != 0 && strcmp(data, "c") != 0) return "";
+    if (!cb->reverse_step || !cb->reverse_continue) return "";
+
+    uint16_t wp_addr = 0;
+    int wp_type = 0;
+    int sig = (data[0] == 's') ? cb->reverse_step() : cb->reverse_continue(&wp_addr, &wp_type);
+    halted = true;
+    if (sig == 0) {
+        last_stop_signal = 5;
+        return "T05replaylog:begin;thread:01;";
+    }
+    last_stop_signal = sig;
+    if (wp_type) return watch_stop_reply(wp_addr, wp_type);
+    return "T" + to_hex_byte((uint8_t)sig) + "thread:01;";
+}
+
 static std::string handle_Z(const char* data) {
     if (!cb) return "E01";
     if (strlen(data) < 3) return "E03";
@@ -439,7 +465,9 @@ static std::string handle_D() {
 }
 
 static std::string handle_qSupported(const char* /*data*/) {
-    return "PacketSize=20000;QStartNoAckMode+;qXfer:features:read+;qXfer:memory-map:read+";
+    std::string features = "PacketSize=20000;QStartNoAckMode+;qXfer:features:read+;qXfer:memory-map:read+";
+    if (cb && cb->reverse_step && cb->reverse_continue) features += ";ReverseStep+;ReverseContinue+";
+    return features;
 }
 
 static std::string handle_query(const char* data) {
@@ -531,6 +559,7 @@ static std::string dispatch_command(const char* payload) {
         case 'M': return handle_M(args);
         case 's': return handle_step(args);
         case 'c': return handle_continue(args);
+        case 'b': return handle_reverse(args);
         case 'Z': return handle_Z(args);
         case 'z': return handle_z(args);
         case 'H': return handle_H(args);
@@ -1027,6 +1056,7 @@ gdb_poll_result_t gdb_stub_poll(void) {
             bool is_step = (first == 's') ||
                            (cmd.compare(0, 7, "vCont;s") == 0);
             bool is_vcont_t = (cmd.compare(0, 7, "vCont;t") == 0);
+            bool is_reverse = (first == 'b');
 
             if (is_continue) {
                 // Continue: dispatch for side effects (optional PC set)
@@ -1072,7 +1102,7 @@ gdb_poll_result_t gdb_stub_poll(void) {
                     resp_queue.push(resp);
                 }
                 resp_cv.notify_one();
-                if (is_step) r = GDB_POLL_STEPPED;
+                if (is_step || is_reverse) r = GDB_POLL_STEPPED;
             }
         }
 
@@ -1107,10 +1137,7 @@ int gdb_stub_get_step_guard(void) {
 void gdb_stub_notify_watchpoint(uint16_t addr, int type) {
     last_stop_signal = 5;  // SIGTRAP
     halted = true;
-    const char* wp_type_str = (type == 2) ? "watch" :
-                              (type == 3) ? "rwatch" : "awatch";
-    std::string stop_reply = "T05" + std::string(wp_type_str) + ":" +
-                             to_hex_le16(addr) + ";thread:01;";
+    std::string stop_reply = watch_stop_reply(addr, type);
     {
         std::lock_guard<std::mutex> lk(resp_mutex);
         resp_queue.push(stop_reply);
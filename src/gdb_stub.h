@@ -23,6 +23,11 @@ typedef struct {
     void     (*reset)(void);
     void     (*continue_exec)(void);    // resume free-running
     void     (*halt)(void);             // stop execution
+    // Reverse execution (optional, nullptr = unsupported).  Both return the
+    // stop signal, or 0 when the oldest recorded state was reached first.
+    // reverse_continue sets *wp_type (2/3/4, 0 = breakpoint) and *wp_addr.
+    int      (*reverse_step)(void);
+    int      (*reverse_continue)(uint16_t* wp_addr, int* wp_type);
 } gdb_stub_callbacks_t;
 
 typedef struct {
@@ -4,8 +4,11 @@
 
 #include "gui_console.h"
 #include "emulator.h"
+#include "emu_cov.h"
 #include "emu_dis6502.h"
 #include "emu_labels.h"
+#include "emu_prof.h"
+#include "emu_thread.h"
 #include "utils.h"
 #include "machine.h"
 
@@ -13,19 +16,81 @@
 #include <string.h>
 #include <deque>
 #include <string>
+#include <mutex>
 
 using namespace std;
 
 deque<string> console_buffer;
+static mutex console_mutex;  // the emulation thread logs too (BP hits)
 
 void gui_con_printmsg(char *msg) {
     string data = msg;
+    lock_guard<mutex> lk(console_mutex);
     console_buffer.push_back(data);
 }
 void gui_con_printmsg(string data) {
+    lock_guard<mutex> lk(console_mutex);
     console_buffer.push_back(data);
 }
 
+// prof [on|off|clear|FILE]: profiler control, or write the flat profile
+// (default n8prof.txt)
+static void gui_con_prof(char *args) {
+    char msg[300];
+    char arg[256] {0};
+    sscanf(args, "%255s", arg);
+    const emu_snapshot_t &snap = *emu_thread_snapshot();
+    if(strcmp(arg, "on") == 0) {
+        emu_thread_post(EMU_CMD_PROF, 0, EMU_PROF_ON);
+    }
+    else if(strcmp(arg, "off") == 0) {
+        emu_thread_post(EMU_CMD_PROF, 0, EMU_PROF_OFF);
+    }
+    else if(strcmp(arg, "clear") == 0) {
+        emu_thread_post(EMU_CMD_PROF, 0, EMU_PROF_CLEAR);
+    }
+    else if(!snap.prof_on) {
+        gui_con_printmsg(string("profiler is off (prof on)\r\n"));
+    }
+    else {
+        const char *file = arg[0] ? arg : "n8prof.txt";
+        if(emu_prof_save(file, snap.prof)) snprintf(msg, sizeof(msg), "profile written to %s\r\n", file);
+        else snprintf(msg, sizeof(msg), "can't write %s\r\n", file);
+        gui_con_printmsg(msg);
+    }
+}
+
+// cov [on|off|clear|FILE [DBG]]: coverage control, or write an lcov
+// tracefile (default n8cov.info) mapped through the ld65 debug info DBG
+// (default firmware/N8firmware.dbg)
+static void gui_con_cov(char *args) {
+    char msg[600];
+    char arg[256] {0}, dbg[256] {0};
+    sscanf(args, "%255s %255s", arg, dbg);
+    const emu_snapshot_t &snap = *emu_thread_snapshot();
+    if(strcmp(arg, "on") == 0) {
+        emu_thread_post(EMU_CMD_COV, 0, EMU_COV_CMD_ON);
+    }
+    else if(strcmp(arg, "off") == 0) {
+        emu_thread_post(EMU_CMD_COV, 0, EMU_COV_CMD_OFF);
+    }
+    else if(strcmp(arg, "clear") == 0) {
+        emu_thread_post(EMU_CMD_COV, 0, EMU_COV_CMD_CLEAR);
+    }
+    else if(!snap.cov_on) {
+        gui_con_printmsg(string("coverage is off (cov on)\r\n"));
+    }
+    else {
+        const char *file = arg[0] ? arg : "n8cov.info";
+        const char *dbg_file = dbg[0] ? dbg : "firmware/N8firmware.dbg";
+        emu_cov_map_t map;
+        if(!emu_cov_load_dbg(dbg_file, map)) snprintf(msg, sizeof(msg), "can't read %s\r\n", dbg_file);
+        else if(emu_cov_lcov(file, map, snap.cov, snap.mem)) snprintf(msg, sizeof(msg), "coverage written to %s\r\n", file);
+        else snprintf(msg, sizeof(msg), "can't write %s\r\n", file);
+        gui_con_printmsg(msg);
+    }
+}
+
 void gui_show_console_window(bool &show_console_window) {
     static char cmd_line[1024] {0};
     // char debug_msg[1256] {0};
@@ -36,10 +101,12 @@ void gui_show_console_window(bool &show_console_window) {
     ImGui::Text("Console:");
     ImGui::BeginChild("console",ImVec2(0,-25.0));
     
+    console_mutex.lock();
     for(std::size_t n = 0; n<console_buffer.size(); n++) {
         
         ImGui::Text(console_buffer[n].c_str());
     }
+    console_mutex.unlock();
     ImGui::SetScrollY(ImGui::GetScrollMaxY());
     ImGui::EndChild();
     if(ImGui::InputText("CMD", cmd_line, IM_ARRAYSIZE(cmd_line),ImGuiInputTextFlags_EnterReturnsTrue)) { 
@@ -51,18 +118,28 @@ void gui_show_console_window(bool &show_console_window) {
             case 'd':
                 emu_dis6502_log(args);
                 break;
+            case 'p':
+                if(strcmp(cmd, "prof") == 0) {
+                    gui_con_prof(args);
+                }
+                break;
             case 'b':
                 if(cmd[1] == 'p')
-                    emulator_setbp(args);
+                    emu_thread_setbp(args);
                 break;
             case 'c':
-                if(cmd[1] == 'l' && cmd[2] == 'r')
+                if(cmd[1] == 'l' && cmd[2] == 'r') {
+                    lock_guard<mutex> lk(console_mutex);
                     while(console_buffer.size() > 0)
                         console_buffer.pop_back();
+                }
+                else if(strcmp(cmd, "cov") == 0) {
+                    gui_con_cov(args);
+                }
                 break;
             case 's':
                 if(strncmp(args, "bp", 2) == 0) {
-                    emulator_logbp();
+                    emu_thread_post(EMU_CMD_BP_LOG);
                 }
                 else
                 if(strncmp(args, "l", 2) == 0) {
@@ -0,0 +1,135 @@
+#include "../imgui/imgui.h"
+#include <SDL.h>
+#if defined(IMGUI_IMPL_OPENGL_ES2)
+#include <SDL_opengles2.h>
+#else
+#include <SDL_opengl.h>
+#endif
+
+#include "gui_heat.h"
+#include "emu_labels.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <list>
+#include <string>
+
+using namespace std;
+
+enum { HEAT_R, HEAT_W, HEAT_X, HEAT_KINDS };
+
+// The emulation thread only counts.  Totals are built here from the
+// difference between successive snapshots (the counters wrap), and each
+// address keeps a decaying activity level per kind for the picture.
+struct gui_heat_t {
+    uint32_t prev[HEAT_KINDS][1 << 16];
+    uint64_t total[HEAT_KINDS][1 << 16];
+    float    level[HEAT_KINDS][1 << 16];
+    uint32_t pixels[1 << 16];
+};
+
+static gui_heat_t *heat = nullptr;      // allocated when the window first opens
+static GLuint heat_tex = 0;
+
+static void heat_update(const emu_snapshot_t &snap, float decay) {
+    const uint32_t *cur[HEAT_KINDS] = { snap.heat.r, snap.heat.w, snap.heat.x };
+    float hottest = 0.0f;
+    for (int k = 0; k < HEAT_KINDS; k++) {
+        uint32_t *prev = heat->prev[k];
+        uint64_t *total = heat->total[k];
+        float *level = heat->level[k];
+        for (int a = 0; a < (1 << 16); a++) {
+            const uint32_t d = cur[k][a] - prev[a];
+            prev[a] = cur[k][a];
+            total[a] += d;
+            float l = level[a] * decay + (float)d;
+            if (l < 0.01f) l = 0.0f;
+            level[a] = l;
+            if (l > hottest) hottest = l;
+        }
+    }
+
+    // Log scale: reads green, writes red, opcode fetches blue
+    const float scale = hottest > 0.0f ? 255.0f / logf(1.0f + hottest) : 0.0f;
+    for (int a = 0; a < (1 << 16); a++) {
+        uint32_t c[HEAT_KINDS];
+        for (int k = 0; k < HEAT_KINDS; k++) {
+            const float l = heat->level[k][a];
+            c[k] = l > 0.0f ? (uint32_t)(logf(1.0f + l) * scale) : 0;
+        }
+        heat->pixels[a] = IM_COL32(c[HEAT_W], c[HEAT_R], c[HEAT_X], 255);
+    }
+}
+
+void gui_show_heat_window(bool &show_heat_window, const emu_snapshot_t &snap) {
+    static float half_life = 1.0f;      // seconds
+    static bool hold = false;
+    static int zoom = 1;                // 1x .. 3x
+    static uint32_t seen_gen = UINT32_MAX;
+
+    ImGui::Begin("Heatmap", &show_heat_window);
+
+    bool on = snap.heat_on;
+    if (ImGui::Checkbox("Enable", &on)) {
+        emu_thread_post(EMU_CMD_HEAT, 0, on);
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Hold", &hold);
+    ImGui::SameLine();
+    ImGui::BeginDisabled(hold);
+    ImGui::SetNextItemWidth(120);
+    ImGui::SliderFloat("Half-life", &half_life, 0.1f, 10.0f, "%.1f s", ImGuiSliderFlags_Logarithmic);
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(60);
+    ImGui::Combo("Zoom", &zoom, "1x\0" "2x\0" "3x\0");
+    ImGui::SameLine();
+    const bool clear = ImGui::Button("Clear");
+
+    if (!heat) heat = new gui_heat_t();
+    if (!heat_tex) {
+        glGenTextures(1, &heat_tex);
+        glBindTexture(GL_TEXTURE_2D, heat_tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 256, 0, GL_RGBA, GL_UNSIGNED_BYTE, heat->pixels);
+    }
+    if (snap.heat_gen != seen_gen) {
+        // Counters restarted (or went away): so does everything built on them
+        memset(heat->prev, 0, sizeof(heat->prev));
+        seen_gen = snap.heat_gen;
+    }
+    if (clear || !snap.heat_on) {
+        memset(heat->total, 0, sizeof(heat->total));
+        memset(heat->level, 0, sizeof(heat->level));
+    }
+    if (snap.heat_on) {
+        const float decay = hold ? 1.0f : powf(0.5f, ImGui::GetIO().DeltaTime / half_life);
+        heat_update(snap, decay);
+        glBindTexture(GL_TEXTURE_2D, heat_tex);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 256, GL_RGBA, GL_UNSIGNED_BYTE, heat->pixels);
+    }
+
+    ImGui::Text("Reads green, writes red, opcode fetches blue.  One row per page.");
+    const float size = 256.0f * (zoom + 1);
+    ImGui::Image((ImTextureID)(intptr_t)heat_tex, ImVec2(size, size));
+    if (ImGui::IsItemHovered()) {
+        const ImVec2 p0 = ImGui::GetItemRectMin();
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        const int x = (int)((mouse.x - p0.x) / (zoom + 1));
+        const int y = (int)((mouse.y - p0.y) / (zoom + 1));
+        if (x >= 0 && x < 256 && y >= 0 && y < 256) {
+            const uint16_t addr = (uint16_t)(y << 8 | x);
+            list<string> labels = emu_labels_get(addr);
+            ImGui::BeginTooltip();
+            ImGui::Text("$%4.4X  %s", addr, labels.empty() ? "" : labels.front().c_str());
+            ImGui::Text("read %llu  write %llu  exec %llu",
+                        (unsigned long long)heat->total[HEAT_R][addr],
+                        (unsigned long long)heat->total[HEAT_W][addr],
+                        (unsigned long long)heat->total[HEAT_X][addr]);
+            ImGui::EndTooltip();
+        }
+    }
+    ImGui::End();
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "emu_thread.h"
+
+// Memory access heatmap (emu_heat.h): one pixel per address, one row per
+// page; hover for the address, its label and the counts.
+void gui_show_heat_window(bool &show_heat_window, const emu_snapshot_t &snap);
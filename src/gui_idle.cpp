@@ -0,0 +1,21 @@
+#include "gui_idle.h"
+
+bool gui_idle_wake(gui_idle_t &g) {
+    return !g.wake_queued.exchange(true);
+}
+
+int gui_idle_timeout(const gui_idle_t &g, bool halted, uint32_t now) {
+    if (halted && g.settle == 0) return GUI_IDLE_MS;
+    const int32_t left = (int32_t)(g.last_frame + 1000 / GUI_RUN_FPS - now);
+    return left > 0 ? left : 0;
+}
+
+void gui_idle_frame(gui_idle_t &g, uint32_t now) {
+    g.wake_queued.store(false);
+    if (g.settle > 0) g.settle--;
+    g.last_frame = now;
+}
+
+void gui_idle_event(gui_idle_t &g, bool wake) {
+    if (!wake) g.settle = GUI_SETTLE_FRAMES;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// GUI frame pacing (main.cpp), kept free of SDL so the tests can drive it.
+// Vsync is off, so frames are paced here: while the CPU runs, at most
+// GUI_RUN_FPS; while it's halted (paused, stopped at a breakpoint, held by
+// GDB) the loop blocks until input arrives, the emulation thread wakes it
+// (emu_thread_set_wake) or GUI_IDLE_MS passes.  After input a few more
+// frames go out at the running rate so ImGui can settle hover and focus
+// changes.
+//
+// Each frame: gui_idle_timeout(), wait for an event that long, then
+// gui_idle_frame() before handling any event, then gui_idle_event() for
+// every event handled (the waited-for one and the ones drained after it).
+
+#include <atomic>
+#include <stdint.h>
+
+#define GUI_RUN_FPS         60
+#define GUI_IDLE_MS         500
+#define GUI_SETTLE_FRAMES   3
+
+struct gui_idle_t {
+    std::atomic<bool> wake_queued{false};   // a wake event is in the queue
+    int      settle = GUI_SETTLE_FRAMES;    // frames left at the running rate
+    uint32_t last_frame = 0;                // ms
+};
+
+// Emulation thread: true if the caller should queue a wake event; false
+// while one is already queued, so there is at most one at a time
+bool gui_idle_wake(gui_idle_t &g);
+
+// How long to wait for the next event, ms; 0: just poll
+int gui_idle_timeout(const gui_idle_t &g, bool halted, uint32_t now);
+
+// The wait returned: any wake event queued so far is handled this frame,
+// wherever it sits in the queue, so the next wake queues a new one
+void gui_idle_frame(gui_idle_t &g, uint32_t now);
+
+// An event was handled; input (anything but a wake) keeps frames coming
+void gui_idle_event(gui_idle_t &g, bool wake);
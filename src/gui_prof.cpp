@@ -0,0 +1,133 @@
+#include "../imgui/imgui.h"
+
+#include "gui_prof.h"
+#include "emu_prof.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum { PROF_COL_SYMBOL, PROF_COL_ADDR, PROF_COL_CYCLES };
+
+static void prof_sort(vector<emu_prof_sym_t> &syms, const ImGuiTableColumnSortSpecs &spec) {
+    const bool up = spec.SortDirection == ImGuiSortDirection_Ascending;
+    stable_sort(syms.begin(), syms.end(), [&](const emu_prof_sym_t &a, const emu_prof_sym_t &b) {
+        int c = 0;
+        switch (spec.ColumnUserID) {
+            case PROF_COL_SYMBOL: c = a.name.compare(b.name); break;
+            case PROF_COL_ADDR:   c = (int)a.addr - (int)b.addr; break;
+            default:              c = a.cycles < b.cycles ? -1 : a.cycles > b.cycles; break;
+        }
+        return up ? c < 0 : c > 0;
+    });
+}
+
+void gui_show_prof_window(bool &show_prof_window, const emu_snapshot_t &snap) {
+    static vector<emu_prof_sym_t> syms;
+    static uint64_t total = 0;
+    static double last_update = -1.0;
+    static char save_file[256] = "n8prof.txt";
+    static char graph_file[256] = "callgrind.out.n8";
+    static char status[300] {0};
+    static bool graph_pending = false;
+
+    ImGui::Begin("Profile", &show_prof_window);
+
+    bool on = snap.prof_on;
+    if (ImGui::Checkbox("Enable", &on)) {
+        emu_thread_post(EMU_CMD_PROF, 0, on ? EMU_PROF_ON : EMU_PROF_OFF);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear")) {
+        emu_thread_post(EMU_CMD_PROF, 0, EMU_PROF_CLEAR);
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(160);
+    ImGui::InputText("##save", save_file, IM_ARRAYSIZE(save_file));
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!snap.prof_on);
+    if (ImGui::Button("Save")) {
+        if (emu_prof_save(save_file, snap.prof)) snprintf(status, sizeof(status), "written to %s", save_file);
+        else snprintf(status, sizeof(status), "can't write %s", save_file);
+    }
+    ImGui::EndDisabled();
+
+    // The call graph lives on the emulation thread: ask for a copy and
+    // write it out once it arrives
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(160);
+    ImGui::InputText("##graph", graph_file, IM_ARRAYSIZE(graph_file));
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!snap.prof_on || graph_pending);
+    if (ImGui::Button("Callgrind")) {
+        emu_thread_prof_graph_request();
+        graph_pending = true;
+    }
+    ImGui::EndDisabled();
+    const emu_prof_graph_t *graph = graph_pending ? emu_thread_prof_graph() : nullptr;
+    if (graph) {
+        graph_pending = false;
+        if (emu_prof_callgrind(graph_file, *graph)) {
+            snprintf(status, sizeof(status), "call graph written to %s", graph_file);
+        } else {
+            snprintf(status, sizeof(status), "can't write %s", graph_file);
+        }
+    }
+
+    // Re-aggregate a few times a second, not every frame
+    bool resort = false;
+    if (!snap.prof_on) {
+        syms.clear();
+        total = 0;
+    } else if (ImGui::GetTime() - last_update > 0.25) {
+        last_update = ImGui::GetTime();
+        emu_prof_symbols(snap.prof, syms);
+        total = 0;
+        for (const emu_prof_sym_t &s : syms) total += s.cycles;
+        resort = true;
+    }
+    ImGui::Text("%llu cycles, %zu symbols  %s", (unsigned long long)total, syms.size(), status);
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg |
+                                  ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY |
+                                  ImGuiTableFlags_Resizable;
+    if (ImGui::BeginTable("prof", 4, flags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Symbol", ImGuiTableColumnFlags_WidthStretch, 0.0f, PROF_COL_SYMBOL);
+        ImGui::TableSetupColumn("Addr", ImGuiTableColumnFlags_WidthFixed, 0.0f, PROF_COL_ADDR);
+        ImGui::TableSetupColumn("Cycles", ImGuiTableColumnFlags_WidthFixed |
+                                ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending,
+                                0.0f, PROF_COL_CYCLES);
+        ImGui::TableSetupColumn("%", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoSort);
+        ImGui::TableHeadersRow();
+
+        ImGuiTableSortSpecs *sort = ImGui::TableGetSortSpecs();
+        if (sort && (sort->SpecsDirty || resort) && sort->SpecsCount > 0) {
+            prof_sort(syms, sort->Specs[0]);
+            sort->SpecsDirty = false;
+        }
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)syms.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const emu_prof_sym_t &s = syms[row];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(s.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("$%4.4X", s.addr);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)s.cycles);
+                ImGui::TableNextColumn();
+                ImGui::Text("%6.2f", total ? 100.0 * s.cycles / total : 0.0);
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
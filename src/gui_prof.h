@@ -0,0 +1,7 @@
+#pragma once
+
+#include "emu_thread.h"
+
+// Flat profile viewer (emu_prof.h): cycles per symbol, sortable, and a
+// save button for the same table the console's "prof" command writes.
+void gui_show_prof_window(bool &show_prof_window, const emu_snapshot_t &snap);
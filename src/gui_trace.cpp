@@ -0,0 +1,100 @@
+#include "../imgui/imgui.h"
+
+#include "gui_trace.h"
+#include "emu_dis6502.h"
+#include "emu_labels.h"
+#include "emu_trace.h"
+
+#include <stdio.h>
+#include <list>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const uint32_t trace_sizes[] = { 0, 1u << 16, 1u << 18, 1u << 20, EMU_TRACE_MAX };
+
+// The ring belongs to the emulation thread; the window shows a copy,
+// taken whenever the CPU has stopped somewhere new (or on Refresh).
+void gui_show_trace_window(bool &show_trace_window, const emu_snapshot_t &snap) {
+    static int size_idx = 0;
+    static char dump_file[256] = "trace.bin";
+    static char status[300] {0};
+    static uint64_t shown_tick = UINT64_MAX;
+    static bool pending = false;
+    static bool scroll_to_end = false;
+
+    ImGui::Begin("Trace", &show_trace_window);
+
+    for (int i = 0; i < IM_ARRAYSIZE(trace_sizes); i++) {
+        if (trace_sizes[i] == snap.trace_capacity) size_idx = i;
+    }
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::Combo("Entries", &size_idx, "Off\0" "64K\0" "256K\0" "1M\0" "4M\0")) {
+        emu_thread_trace(trace_sizes[size_idx]);
+        shown_tick = UINT64_MAX;
+    }
+
+    uint64_t copy_tick = 0;
+    const vector<emu_trace_entry_t> *copy = emu_thread_trace_copy(&copy_tick);
+    if (copy && pending) {
+        pending = false;
+        shown_tick = copy_tick;
+        scroll_to_end = true;
+    }
+    const bool want = snap.trace_capacity && !snap.running && shown_tick != snap.tick_count;
+    ImGui::SameLine();
+    if ((ImGui::Button("Refresh") || want) && copy && !pending) {
+        emu_thread_trace_request();
+        pending = true;
+        copy = nullptr;
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(160);
+    ImGui::InputText("##dump", dump_file, IM_ARRAYSIZE(dump_file));
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!copy || copy->empty());
+    if (ImGui::Button("Dump")) {
+        if (emu_trace_save(dump_file, *copy)) {
+            snprintf(status, sizeof(status), "%zu entries written to %s", copy->size(), dump_file);
+        } else {
+            snprintf(status, sizeof(status), "can't write %s", dump_file);
+        }
+    }
+    ImGui::EndDisabled();
+
+    if (!copy) {
+        ImGui::Text("Copying...");
+        ImGui::End();
+        return;
+    }
+    if (snap.trace_capacity) {
+        ImGui::Text("%zu entries up to cycle %llu%s  %s", copy->size(),
+                    (unsigned long long)shown_tick, snap.running ? " (running)" : "", status);
+    } else {
+        ImGui::Text("Trace off");
+    }
+
+    // Operands are decoded from the current memory image
+    ImGui::BeginChild("trace", ImVec2(0, 0));
+    ImGuiListClipper clipper;
+    clipper.Begin((int)copy->size());
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            const emu_trace_entry_t &e = (*copy)[row];
+            char decode[256] {0};
+            emu_dis6502_decode(e.pc, decode, sizeof(decode));
+            list<string> labels = emu_labels_get(e.pc);
+            ImGui::Text("%12llu  %4.4x  %2.2x  A=%2.2x X=%2.2x Y=%2.2x S=%2.2x P=%2.2x  %-20s %s",
+                        (unsigned long long)e.tick, e.pc, e.op, e.a, e.x, e.y, e.s, e.p,
+                        decode, labels.empty() ? "" : labels.front().c_str());
+        }
+    }
+    clipper.End();
+    if (scroll_to_end) {
+        ImGui::SetScrollHereY(1.0f);
+        scroll_to_end = false;
+    }
+    ImGui::EndChild();
+    ImGui::End();
+}
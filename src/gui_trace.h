@@ -0,0 +1,7 @@
+#pragma once
+
+#include "emu_thread.h"
+
+// Instruction trace viewer (emu_trace.h): ring size, the copy taken when
+// the CPU last stopped, binary dump.
+void gui_show_trace_window(bool &show_trace_window, const emu_snapshot_t &snap);
@@ -0,0 +1,299 @@
+// Headless N8 runner: no SDL/GL/ImGui, just the CPU, bus and TTY.
+// Runs a ROM for N cycles (or until a breakpoint) and reports ticks/sec.
+// With -F it boots once and fans out one forked run per input line.
+// -R/-P record or replay the input log (emu_input.h) from power-on.
+
+#include "emulator.h"
+#include "emu_cov.h"
+#include "emu_fork.h"
+#include "emu_input.h"
+#include "emu_prof.h"
+#include "emu_trace.h"
+#include "emu_tty.h"
+#include "emu_labels.h"
+#include "n8_machine.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// ---- gui_console replacement (emulator/labels log through this) ----
+
+void gui_con_printmsg(char *msg) {
+    fprintf(stderr, "%s", msg);
+}
+void gui_con_printmsg(std::string data) {
+    fprintf(stderr, "%s", data.c_str());
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -r FILE   ROM image (default N8firmware)\n"
+        "  -s FILE   symbol file (default: none)\n"
+        "  -c N      cycles to run (default 10000000, 0 = forever)\n"
+        "  -b ADDR   stop when PC reaches ADDR ($hex, 0xhex or dec; repeatable)\n"
+        "  -f        fast mode: instruction-level interpreter where possible\n"
+        "  -i        don't skip idle loops\n"
+        "  -q        no summary on stderr\n"
+        "  -F FILE   fan-out: boot, then fork one run per line of FILE; each\n"
+        "            child types its line (plus CR) and runs -c cycles\n"
+        "            (at least 1: a child can't run forever).\n"
+        "            Boot stops at the first -b hit, children at the next.\n"
+        "            Prints one JSON object per line on stdout\n"
+        "  -B N      fan-out boot cycles (default 10000000)\n"
+        "  -j N      fan-out: children at once (default: one per CPU)\n"
+        "  -R FILE   record every input event (TTY, reset, debugger writes)\n"
+        "            with its cycle to FILE\n"
+        "  -P FILE   replay FILE (recorded with the same ROM) at the same\n"
+        "            cycles; host input waits until the recording's end\n"
+        "  -t N      trace the last N instructions (up to 4M)\n"
+        "  -T FILE   write the trace to FILE when the run ends (default trace.bin)\n"
+        "  -p FILE   profile: write cycles per symbol (-s) to FILE when the run ends\n"
+        "  -g FILE   profile: write the call graph to FILE (callgrind format)\n"
+        "  -v FILE   coverage: write an lcov tracefile to FILE when the run ends\n"
+        "  -d FILE   ld65 debug info for -v (default firmware/N8firmware.dbg)\n", prog);
+}
+
+static const char *stop_name(emu_stop_reason_t r) {
+    switch(r) {
+        case EMU_STOP_CYCLES:     return "cycles";
+        case EMU_STOP_BREAKPOINT: return "breakpoint";
+        case EMU_STOP_WATCHPOINT: return "watchpoint";
+    }
+    return "?";
+}
+
+static void json_string(const std::string &s) {
+    putchar('"');
+    for(unsigned char c : s) {
+        if(c == '"' || c == '\\') printf("\\%c", c);
+        else if(c < 0x20 || c >= 0x7F) printf("\\u%04x", c);
+        else putchar(c);
+    }
+    putchar('"');
+}
+
+// -F: boot once, fork a child per line of path, report each as JSON
+static int fan_out(const char *path, uint64_t boot_cycles, uint64_t max_cycles, int jobs, bool quiet) {
+    FILE *f = fopen(path, "r");
+    if(!f) {
+        fprintf(stderr, "can't open %s\n", path);
+        return 1;
+    }
+    std::vector<std::string> inputs;
+    char line[1024];
+    while(fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = 0;
+        inputs.push_back(std::string(line) + "\r");
+    }
+    fclose(f);
+
+    emu_stop_reason_t reason = EMU_STOP_CYCLES;
+    auto t0 = std::chrono::steady_clock::now();
+    const uint64_t boot = emulator_run(boot_cycles, &reason);
+    auto t1 = std::chrono::steady_clock::now();
+    fflush(stdout);     // boot banner, so it isn't mixed into the JSON
+
+    std::vector<emu_fork_result_t> results;
+    const bool ok = emu_fork_run(inputs, max_cycles, jobs, results);
+    auto t2 = std::chrono::steady_clock::now();
+
+    int failed = 0;
+    for(size_t i = 0; i < results.size(); i++) {
+        const emu_fork_result_t &r = results[i];
+        const bool clean = WIFEXITED(r.status) && WEXITSTATUS(r.status) == 0;
+        if(!clean) failed++;
+        printf("{\"variant\":%zu,\"input\":", i);
+        json_string(r.input);
+        printf(",\"stop\":\"%s\",\"cycles\":%llu,\"status\":%d,\"output\":",
+               stop_name(r.reason), (unsigned long long)r.cycles, r.status);
+        json_string(r.output);
+        printf("}\n");
+    }
+    fflush(stdout);
+
+    if(!quiet) {
+        fprintf(stderr, "\r\n[n8-headless] boot stop=%s cycles=%llu time=%.3fs; %zu variants, %d failed, time=%.3fs\r\n",
+                stop_name(reason), (unsigned long long)boot,
+                std::chrono::duration<double>(t1 - t0).count(), results.size(), failed,
+                std::chrono::duration<double>(t2 - t1).count());
+    }
+    return ok && failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    uint64_t max_cycles = 10000000;
+    bool quiet = false;
+    bool fast = false;
+    bool idle = true;
+    bool any_bp = false;
+    const char *fan_file = nullptr;
+    uint64_t boot_cycles = 10000000;
+    int jobs = 0;
+    const char *record_file = nullptr;
+    const char *replay_file = nullptr;
+    uint32_t trace_entries = 0;
+    const char *trace_file = "trace.bin";
+    const char *prof_file = nullptr;
+    const char *graph_file = nullptr;
+    const char *cov_file = nullptr;
+    const char *dbg_file = "firmware/N8firmware.dbg";
+
+    emu_labels_set_file(nullptr);
+
+    for(int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if(strcmp(arg, "-q") == 0) {
+            quiet = true;
+            continue;
+        }
+        if(strcmp(arg, "-f") == 0) {
+            fast = true;
+            continue;
+        }
+        if(strcmp(arg, "-i") == 0) {
+            idle = false;
+            continue;
+        }
+        if(arg[0] != '-' || arg[1] == 0 || arg[2] != 0 || i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        char *val = argv[++i];
+        switch(arg[1]) {
+            case 'r': emulator_set_rom_file(val); break;
+            case 's': emu_labels_set_file(val); break;
+            case 'c': max_cycles = strtoull(val, nullptr, 0); break;
+            case 'F': fan_file = val; break;
+            case 'B': boot_cycles = strtoull(val, nullptr, 0); break;
+            case 'j': jobs = atoi(val); break;
+            case 'R': record_file = val; break;
+            case 'P': replay_file = val; break;
+            case 't': trace_entries = (uint32_t)strtoul(val, nullptr, 0); break;
+            case 'T': trace_file = val; break;
+            case 'p': prof_file = val; break;
+            case 'g': graph_file = val; break;
+            case 'v': cov_file = val; break;
+            case 'd': dbg_file = val; break;
+            case 'b': {
+                uint32_t addr = 0;
+                if(my_get_uint(val, addr) == 0 || addr > 0xFFFF) {
+                    fprintf(stderr, "bad address: %s\n", val);
+                    return 1;
+                }
+                emulator_dbg_set(addr, DBG_EXEC);
+                any_bp = true;
+                break;
+            }
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(fan_file && max_cycles == 0) {
+        fprintf(stderr, "-F needs a cycle limit (-c N, N > 0)\n");
+        return 1;
+    }
+
+    emulator_init();
+    emulator_enablebp(any_bp);
+    emulator_enablefast(fast);
+    emulator_enableidle(idle);
+    emu_trace_enable(trace_entries);
+    emu_prof_enable(prof_file || graph_file);
+    emu_cov_enable(cov_file != nullptr);
+
+    if(fan_file) {
+        if(record_file || replay_file) {
+            fprintf(stderr, "-F can't be combined with -R or -P\n");
+            return 1;
+        }
+        return fan_out(fan_file, boot_cycles, max_cycles, jobs, quiet);
+    }
+    if(record_file && replay_file) {
+        fprintf(stderr, "-R and -P can't be combined\n");
+        return 1;
+    }
+    if(record_file && !emu_input_record(record_file)) {
+        fprintf(stderr, "can't write %s\n", record_file);
+        return 1;
+    }
+    if(replay_file && !emu_input_replay(replay_file)) return 1;
+
+    // Run in slices so "-c 0" (forever) still goes through the batch API.
+    const uint64_t slice = 1000000;
+    emu_stop_reason_t reason = EMU_STOP_CYCLES;
+    uint64_t ran = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    while(max_cycles == 0 || ran < max_cycles) {
+        uint64_t n = slice;
+        if(max_cycles && max_cycles - ran < n) n = max_cycles - ran;
+        ran += emu_input_run(n, &reason);
+        if(reason != EMU_STOP_CYCLES) break;
+        // Waiting on input: don't spin (a replay has it all already)
+        if(emulator_idle() && !emu_input_replaying()) tty_wait_input(10);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    if(!quiet) {
+        double secs = std::chrono::duration<double>(t1 - t0).count();
+        double tps = secs > 0.0 ? ran / secs : 0.0;
+        fprintf(stderr, "\r\n[n8-headless] stop=%s pc=$%04X cycles=%llu time=%.3fs ticks/sec=%.0f (%.2f MHz)\r\n",
+                stop_name(reason), emulator_getpc(), (unsigned long long)ran, secs, tps, tps / 1e6);
+        if(record_file) {
+            fprintf(stderr, "[n8-headless] recorded %llu input events to %s\r\n",
+                    (unsigned long long)emu_input_events(), record_file);
+        }
+        if(replay_file) {
+            fprintf(stderr, "[n8-headless] replayed %llu input events from %s%s\r\n",
+                    (unsigned long long)emu_input_events(), replay_file,
+                    emu_input_replaying() ? " (log not finished)" : "");
+        }
+    }
+    emu_input_stop();
+    if(prof_file) {
+        if(!emu_prof_save(prof_file, emu_prof_cycles())) {
+            fprintf(stderr, "can't write %s\n", prof_file);
+            return 1;
+        }
+    }
+    if(graph_file) {
+        emu_prof_graph_t graph;
+        emu_prof_graph(graph);
+        if(!emu_prof_callgrind(graph_file, graph)) {
+            fprintf(stderr, "can't write %s\n", graph_file);
+            return 1;
+        }
+    }
+    if(cov_file) {
+        emu_cov_map_t map;
+        if(!emu_cov_load_dbg(dbg_file, map)) {
+            fprintf(stderr, "can't read %s\n", dbg_file);
+            return 1;
+        }
+        if(!emu_cov_lcov(cov_file, map, emu_cov_hits(), n8->mem)) {
+            fprintf(stderr, "can't write %s\n", cov_file);
+            return 1;
+        }
+    }
+    if(trace_entries) {
+        std::vector<emu_trace_entry_t> trace;
+        emu_trace_copy(trace);
+        if(!emu_trace_save(trace_file, trace)) {
+            fprintf(stderr, "can't write %s\n", trace_file);
+            return 1;
+        }
+        if(!quiet) {
+            fprintf(stderr, "[n8-headless] %zu trace entries written to %s\r\n", trace.size(), trace_file);
+        }
+    }
+    return 0;
+}
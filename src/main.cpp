@@ -30,142 +30,24 @@ using namespace std;
 
 #include "emulator.h"
 #include "emu_dis6502.h"
+#include "emu_input.h"
 #include "machine.h"
 #include "utils.h"
 #include "gdb_stub.h"
 #include "m6502.h"
 #include "emu_tty.h"
+#include "emu_labels.h"
+#include "emu_thread.h"
+#include "gui_idle.h"
+#include "gui_prof.h"
+#include "gui_heat.h"
+#include "gui_trace.h"
 
 const char* glsl_version;
 SDL_WindowFlags window_flags;
 SDL_Window* window;
 SDL_GLContext gl_context;
 
-// ---- Emulator state (file scope for GDB callback access) ----
-static bool run_emulator = false;
-static bool step_emulator = false;
-static bool gdb_halted = false;
-static bool bp_enable = false;
-
-// Externs from emulator.cpp needed by GDB callbacks
-extern m6502_t cpu;
-extern uint64_t pins;
-
-// ---- GDB stub callbacks ----
-
-static uint8_t gdb_read_reg8(int reg_id) {
-    switch (reg_id) {
-        case 0: return emulator_read_a();
-        case 1: return emulator_read_x();
-        case 2: return emulator_read_y();
-        case 3: return emulator_read_s();
-        case 4: return emulator_read_p();
-        default: return 0;
-    }
-}
-
-static uint16_t gdb_read_reg16(int reg_id) {
-    if (reg_id == 5) return emulator_getpc();
-    return 0;
-}
-
-static void gdb_write_reg8(int reg_id, uint8_t val) {
-    switch (reg_id) {
-        case 0: emulator_write_a(val); break;
-        case 1: emulator_write_x(val); break;
-        case 2: emulator_write_y(val); break;
-        case 3: emulator_write_s(val); break;
-        case 4: emulator_write_p(val); break;
-    }
-}
-
-static void gdb_write_reg16(int reg_id, uint16_t val) {
-    if (reg_id == 5) emulator_write_pc(val);
-}
-
-static uint8_t gdb_read_mem(uint16_t addr) {
-    return mem[addr];
-}
-
-static void gdb_write_mem(uint16_t addr, uint8_t val) {
-    mem[addr] = val;
-}
-
-static int gdb_step_instruction(void) {
-    int guard = gdb_stub_get_step_guard();
-    int ticks = 0;
-    do {
-        emulator_step();
-        ticks++;
-        if (ticks >= guard) return 4; // SIGILL — likely jammed
-    } while (!(pins & M6502_SYNC));
-    return 5; // SIGTRAP
-}
-
-static void gdb_set_breakpoint(uint16_t addr) {
-    bp_mask[addr] = true;
-    bp_enable = true;
-    emulator_enablebp(true);
-}
-
-static void gdb_clear_breakpoint(uint16_t addr) {
-    bp_mask[addr] = false;
-    // Disable BP scanning if no breakpoints remain
-    bool any = false;
-    for (int i = 0; i < 65536 && !any; i++) any = bp_mask[i];
-    if (!any) { bp_enable = false; emulator_enablebp(false); }
-}
-
-static void gdb_set_watchpoint(uint16_t addr, int type) {
-    if (type == 2) {          // write watchpoint
-        wp_write_mask[addr] = true;
-    } else if (type == 3) {   // read watchpoint
-        wp_read_mask[addr] = true;
-    } else if (type == 4) {   // access watchpoint
-        wp_write_mask[addr] = true;
-        wp_read_mask[addr] = true;
-    }
-    emulator_enablewp(true);
-}
-
-static void gdb_clear_watchpoint(uint16_t addr, int type) {
-    if (type == 2) {
-        wp_write_mask[addr] = false;
-    } else if (type == 3) {
-        wp_read_mask[addr] = false;
-    } else if (type == 4) {
-        wp_write_mask[addr] = false;
-        wp_read_mask[addr] = false;
-    }
-    // Disable WP scanning if no watchpoints remain
-    bool any = false;
-    for (int i = 0; i < 65536 && !any; i++) any = wp_write_mask[i] || wp_read_mask[i];
-    if (!any) emulator_enablewp(false);
-}
-
-static void gdb_continue_exec(void) {
-    run_emulator = true;
-}
-
-static void gdb_halt(void) {
-    run_emulator = false;
-}
-
-static uint16_t gdb_get_pc(void) {
-    return emulator_getpc();
-}
-
-static int gdb_get_stop_reason(void) {
-    return 5; // SIGTRAP default
-}
-
-static void gdb_reset(void) {
-    // D47: Use M6502_RES pin, NOT emulator_reset()
-    pins |= M6502_RES;
-    tty_reset();
-}
-
-
 int SDL_GL_Init() {
     // Setup SDL
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0)
@@ -217,9 +99,45 @@ int SDL_GL_Init() {
 
     return 0;
 }
+
+// Event-driven frames, paced by gui_idle.h
+#ifndef __EMSCRIPTEN__
+static gui_idle_t gui_idle;
+static Uint32 gui_wake_event = (Uint32)-1;
+
+// Emulation thread: one wake event in the queue at a time
+static void gui_wake() {
+    if (gui_wake_event == (Uint32)-1 || !gui_idle_wake(gui_idle)) return;
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = gui_wake_event;
+    SDL_PushEvent(&event);
+}
+
+// Wait for the next frame; true with an event to handle
+static bool gui_wait_event(SDL_Event &event, bool halted) {
+    const int timeout = gui_idle_timeout(gui_idle, halted, SDL_GetTicks());
+    const bool got = timeout > 0 ? SDL_WaitEventTimeout(&event, timeout) != 0 : SDL_PollEvent(&event) != 0;
+    gui_idle_frame(gui_idle, SDL_GetTicks());
+    return got;
+}
+#endif
+
 // Main code
-int main(int, char**)
+int main(int argc, char** argv)
 {
+    // -R FILE: record the input log, -P FILE: replay one (emu_input.h)
+    const char* record_file = nullptr;
+    const char* replay_file = nullptr;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 < argc && strcmp(argv[i], "-R") == 0) record_file = argv[i + 1];
+        else if (i + 1 < argc && strcmp(argv[i], "-P") == 0) replay_file = argv[i + 1];
+        else {
+            fprintf(stderr, "usage: %s [-R input.log | -P input.log]\n", argv[0]);
+            return 1;
+        }
+    }
+
     int rtn;
     if((rtn = SDL_GL_Init()) != 0) {
         return rtn;
@@ -271,20 +189,18 @@ int main(int, char**)
     //IM_ASSERT(font != nullptr);
 
     emulator_init();
+    if (record_file && !emu_input_record(record_file)) {
+        fprintf(stderr, "can't write %s\n", record_file);
+    }
+    if (replay_file) emu_input_replay(replay_file);
 
-    // GDB stub init
-    static gdb_stub_callbacks_t gdb_cb = {
-        gdb_read_reg8, gdb_read_reg16,
-        gdb_write_reg8, gdb_write_reg16,
-        gdb_read_mem, gdb_write_mem,
-        gdb_step_instruction,
-        gdb_set_breakpoint, gdb_clear_breakpoint,
-        gdb_set_watchpoint, gdb_clear_watchpoint,
-        gdb_get_pc, gdb_get_stop_reason,
-        gdb_reset, gdb_continue_exec, gdb_halt
-    };
+    // GDB stub runs on the emulation thread, next to the CPU it drives
     static gdb_stub_config_t gdb_cfg = { 3333, true, 16 };
-    gdb_stub_init(&gdb_cb, &gdb_cfg);
+#ifndef __EMSCRIPTEN__
+    gui_wake_event = SDL_RegisterEvents(1);
+    emu_thread_set_wake(gui_wake);
+#endif
+    emu_thread_start(&gdb_cfg);
 
     // Our state
     bool show_memmap_window = true;
@@ -295,6 +211,7 @@ int main(int, char**)
 
     // Main loop
     bool done = false;
+    bool halted = false;    // last frame's snapshot, for gui_wait_event()
 
 #ifdef __EMSCRIPTEN__
     // For an Emscripten build we are disabling file-system access, so let's not attempt to do a fopen() of the imgui.ini file.
@@ -306,82 +223,41 @@ int main(int, char**)
 #endif
     {
         static bool show_disasm_window = true;
+        static bool show_trace_window = false;
+        static bool show_prof_window = false;
+        static bool show_heat_window = false;
         static char break_points[128] {0};
 
-        // GDB stub poll
-        switch (gdb_stub_poll()) {
-            case GDB_POLL_HALTED:
-                run_emulator = false;
-                gdb_halted = true;
-                bp_enable = true;
-                emulator_enablebp(true);
-                break;
-            case GDB_POLL_RESUMED:
-                gdb_halted = false;
-                run_emulator = true;
-                break;
-            case GDB_POLL_STEPPED:
-                gdb_halted = true;
-                run_emulator = false;
-                break;
-            case GDB_POLL_DETACHED:
-                gdb_halted = false;
-                // D44: clear all GDB breakpoints and watchpoints on disconnect
-                memset(bp_mask, 0, sizeof(bool) * 65536);
-                memset(wp_write_mask, 0, sizeof(bool) * 65536);
-                memset(wp_read_mask, 0, sizeof(bool) * 65536);
-                bp_enable = false;
-                emulator_enablebp(false);
-                emulator_enablewp(false);
-                break;
-            case GDB_POLL_KILL:
-                gdb_halted = false;
-                run_emulator = true;
-                break;
-            case GDB_POLL_NONE:
-                break;
-        }
+        // Sleep until the frame is due, or while halted until something happens
+        SDL_Event event;
+#ifndef __EMSCRIPTEN__
+        bool have_event = gui_wait_event(event, halted);
+#else
+        bool have_event = false;
+#endif
+
+        // Pick up the emulation thread's latest state, once per frame
+        const emu_snapshot_t &snap = *emu_thread_latest();
+        emu_dis6502_set_source(snap.mem);
+        bool run_emulator = snap.running;
+        bool gdb_halted = snap.gdb_halted;
+        bool gdb_connected = snap.gdb_connected;
+        bool bp_enable = snap.bp_enable;
+        bool fast_enable = snap.fast;
+        static int pace = EMU_PACE_UNLIMITED;
+        halted = !run_emulator || gdb_halted;
 
-        uint32_t steps = 0;
-        if (run_emulator && !gdb_halted) {
-            uint32_t timeout = SDL_GetTicks() + 13;
-            while (!SDL_TICKS_PASSED(SDL_GetTicks(), timeout)) {
-                emulator_step();
-                steps++;
-                if (emulator_bp_hit()) {
-                    run_emulator = false;
-                    emulator_clear_bp_hit();
-                    if (gdb_stub_is_connected()) {
-                        gdb_halted = true;
-                        gdb_stub_notify_stop(5);
-                    }
-                    break;
-                }
-                if (emulator_wp_hit()) {
-                    run_emulator = false;
-                    uint16_t wa = emulator_wp_hit_addr();
-                    int wt = emulator_wp_hit_type();
-                    emulator_clear_wp_hit();
-                    if (gdb_stub_is_connected()) {
-                        gdb_halted = true;
-                        gdb_stub_notify_watchpoint(wa, wt);
-                    }
-                    break;
-                }
-            }
-        } else if (step_emulator && !gdb_halted) {
-            emulator_step();
-            steps++;
-            step_emulator = false;
-        }
         // Poll and handle events (inputs, window resize, etc.)
         // You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
         // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
-        SDL_Event event;
-        while (SDL_PollEvent(&event))
+        while (have_event || SDL_PollEvent(&event))
         {
+            have_event = false;
+#ifndef __EMSCRIPTEN__
+            gui_idle_event(gui_idle, event.type == gui_wake_event);
+#endif
             ImGui_ImplSDL2_ProcessEvent(&event);
             if (event.type == SDL_QUIT)
                 done = true;
@@ -402,58 +278,84 @@ int main(int, char**)
             ImGui::SameLine();  ImGui::Checkbox("Disasm", &show_disasm_window);
             ImGui::SameLine();  ImGui::Checkbox("Memory", &show_memmap_window);
             ImGui::SameLine();  ImGui::Checkbox("Console", &show_console_window);
+            ImGui::SameLine();  ImGui::Checkbox("Trace", &show_trace_window);
+            ImGui::SameLine();  ImGui::Checkbox("Profile", &show_prof_window);
+            ImGui::SameLine();  ImGui::Checkbox("Heatmap", &show_heat_window);
             ImGui::Text("  ");
-            if (gdb_halted && gdb_stub_is_connected())
+            if (gdb_halted && gdb_connected)
                 ImGui::Text("Status: Halted (GDB)");
             else
                 ImGui::Text("Status: %s", run_emulator ? "Running" : "Halted");
 
-            if (gdb_stub_is_connected())
+            if (gdb_connected)
                 ImGui::Text("GDB: Connected (port 3333)");
             else
                 ImGui::Text("GDB: Listening");
 
             ImGui::BeginDisabled(gdb_halted);
             if(ImGui::Button(run_emulator?"Pause":" Run ")) {
-                run_emulator = !run_emulator;
+                emu_thread_post(run_emulator ? EMU_CMD_PAUSE : EMU_CMD_RUN);
             }
             ImGui::SameLine(80);
             ImGui::BeginDisabled(run_emulator);
             if(ImGui::Button("Step")) {
-                step_emulator = true;
+                emu_thread_post(EMU_CMD_STEP);
             }
             ImGui::EndDisabled();
             ImGui::EndDisabled(); // gdb_halted
             ImGui::SameLine(150);
             if(ImGui::Button("Reset")) {
-                emulator_reset();
+                emu_thread_post(EMU_CMD_RESET);
+                emu_labels_init();  // symbols belong to the GUI thread
             }
             ImGui::SameLine(230);
-            ImGui::BeginDisabled(gdb_stub_is_connected());
+            ImGui::BeginDisabled(gdb_connected);
             if(ImGui::Checkbox("BP", &bp_enable)) {
-                emulator_enablebp(bp_enable);
+                emu_thread_post(EMU_CMD_BP_ENABLE, 0, bp_enable);
             }
             ImGui::EndDisabled();
-            ImGui::SameLine(300);
+            ImGui::SameLine(290);
+            if(ImGui::Checkbox("Fast", &fast_enable)) {
+                emu_thread_post(EMU_CMD_FAST, 0, fast_enable);
+            }
+            ImGui::SetNextItemWidth(120);
+            if(ImGui::Combo("Clock", &pace, "Unlimited\0" "1 MHz\0" "2 MHz\0" "4 MHz\0")) {
+                emu_thread_post(EMU_CMD_PACE, 0, (uint8_t)pace);
+            }
             if(ImGui::InputText("BP2", break_points,IM_ARRAYSIZE(break_points))) {
-                emulator_setbp(break_points);
+                emu_thread_setbp(break_points);
+            }
+
+            // Timeline: step back or drag to any recorded cycle while paused
+            ImGui::BeginDisabled(run_emulator || gdb_halted);
+            if(ImGui::Button("Back")) {
+                emu_thread_post(EMU_CMD_STEP_BACK);
+            }
+            ImGui::SameLine();
+            uint64_t seek_tick = snap.tick_count;
+            ImGui::SetNextItemWidth(-1);
+            if(ImGui::SliderScalar("##timeline", ImGuiDataType_U64, &seek_tick,
+                                   &snap.history_first, &snap.history_last, "cycle %llu")) {
+                emu_thread_seek(seek_tick);
             }
+            ImGui::EndDisabled();
 
-            ImGui::Text("Steps per frame: %d", steps);
-            ImGui::Text("Steps per sec: %f:", io.Framerate * steps);
+            ImGui::Text("Steps per frame: %.0f", snap.ticks_per_sec / io.Framerate);
+            ImGui::Text("Steps per sec: %.0f (%llu per clock check)", snap.ticks_per_sec,
+                        (unsigned long long)snap.chunk_ticks);
             ImGui::End();
         }
 
         
         // 3. Show Memory dumpo window.
         if (show_memmap_window) {
-            emulator_show_memdump_window(show_memmap_window);
+            emulator_show_memdump_window(show_memmap_window, snap);
         }
 
         // Show CPU register status window
         if (show_status_window)
         {
-            emulator_show_status_window(show_status_window,1000.0f / io.Framerate,io.Framerate);
+            emulator_show_status_window(show_status_window,1000.0f / io.Framerate,io.Framerate, snap);
         }
 
         if (show_disasm_window) {
@@ -462,6 +364,15 @@ int main(int, char**)
         if (show_console_window) {
             emulator_show_console_window(show_console_window);
         }
+        if (show_trace_window) {
+            gui_show_trace_window(show_trace_window, snap);
+        }
+        if (show_prof_window) {
+            gui_show_prof_window(show_prof_window, snap);
+        }
+        if (show_heat_window) {
+            gui_show_heat_window(show_heat_window, snap);
+        }
 
         // Rendering
         ImGui::Render();
@@ -489,7 +400,7 @@ int main(int, char**)
 #endif
 
     // Cleanup
-    gdb_stub_shutdown();
+    emu_thread_stop();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
@@ -0,0 +1,129 @@
+#pragma once
+
+// One emulated N8: CPU, memory, bus, devices and debug state.
+//
+// Every emulator_* / tty_* / emu_sched_* call works on the calling
+// thread's current machine, n8.  That is n8_default (the GUI/headless
+// machine) until the thread binds another with n8_machine_bind(), so
+// independent machines can run side by side, one per thread:
+//
+//     N8Machine *m = n8_machine_new();
+//     n8_machine_bind(m);
+//     ... load code, emulator_run() ...
+//     n8_machine_bind(nullptr);
+//     n8_machine_free(m);
+//
+// A machine must only be driven by one thread at a time.  Firmware
+// symbols (emu_labels) and the host terminal are per process.
+
+#include "m6502.h"
+#include "emulator.h"
+#include "emu_sched.h"
+#include "emu_tty.h"
+#include "n8_memory_map.h"
+
+#include <string.h>
+
+struct emu_page_t {
+    emu_bus_fn io;      // called after the backing access, nullptr for RAM/ROM
+    bool rom;           // CPU writes ignored
+};
+
+struct emu_bb_cache_t;  // emu_fast6502.cpp, allocated on first use
+struct emu_rewind_t;    // emu_rewind.cpp, allocated by emu_rewind_enable()
+struct emu_input_t;     // emu_input.cpp, allocated while recording or replaying
+struct emu_trace_t;     // emu_trace.h, allocated by emu_trace_enable()
+struct emu_prof_t;      // emu_prof.h, allocated by emu_prof_enable()
+struct emu_heat_t;      // emu_heat.h, allocated by emu_heat_enable()
+struct emu_cov_t;       // emu_cov.h, allocated by emu_cov_enable()
+
+// Idle-loop detection, see emulator_idle_check()
+struct emu_idle_t {
+    uint16_t head;          // loop head being watched (last backward target)
+    uint16_t prev;          // PC at the previous instruction boundary
+    uint8_t  a, x, y, s, p;
+    uint32_t writes;        // cpu_writes when last at head
+    uint64_t tick;          // tick_count when last at head
+    bool     quiet;         // devices were quiet when last at head
+};
+
+struct N8Machine {
+    // CPU and memory
+    m6502_t      cpu;
+    m6502_desc_t desc;
+    uint64_t     pins = 0;
+    uint64_t     tick_count = 0;
+    uint16_t     cur_instruction = 0;
+    uint8_t      mem[1 << 16] {};
+
+    // Bus, see emulator_bus_init().  Every write stamps its page with the
+    // current generation, so any number of consumers (GUI snapshot, ...)
+    // can ask "which pages changed since I last looked".
+    emu_page_t page_table[256] {};
+    emu_dev_fn dev_slots[N8_DEV_SIZE / N8_DEV_SLOT_SIZE] {};
+    uint32_t   mem_page_gen[256] {};
+    uint32_t   mem_gen = 1;
+    uint32_t   cpu_writes = 0;      // CPU write cycles (any page), see idle detection
+
+    // Debug flags: one byte per address (DBG_* bits) plus one bit per page
+    // that is set while any address in the page has an armed flag.  The
+    // bus path only looks at dbg_flags[] when the page bit is set.
+    uint8_t  dbg_flags[1 << 16] {};
+    uint64_t dbg_pages[4] {};
+    bool     bp_enable = false;
+    bool     bp_hit = false;
+    bool     wp_enable = false;
+    bool     wp_hit_flag = false;
+    uint16_t wp_addr = 0;
+    int      wp_type = 0;           // 2=write, 3=read, 4=access
+    bool     dbg_quiet = false;     // no console message on hits (history scans)
+    emu_trace_t *trace = nullptr;   // instruction trace ring, nullptr while off
+    emu_prof_t  *prof = nullptr;    // cycle profile, nullptr while off
+    emu_heat_t  *heat = nullptr;    // access counters, nullptr while off
+    emu_cov_t   *cov = nullptr;     // code coverage, nullptr while off
+
+    // Fast path, see emu_fast6502.h
+    bool            fast_enable = false;
+    uint8_t         bb_code_pages[256] {};  // pages holding cached blocks
+    emu_bb_cache_t *bb = nullptr;
+
+    // Idle-loop skipping
+    emu_idle_t idle {};
+    bool       idle_enable = true;
+    bool       idle_hit = false;
+
+    // Devices
+    emu_sched_t sched;
+    uint8_t     irq_flags = 0;      // emu_irq.h
+    emu_tty_t   tty;
+
+    // Reverse execution history, see emu_rewind.h
+    emu_rewind_t *rewind = nullptr;
+
+    // Input log being recorded or replayed, see emu_input.h
+    emu_input_t *input = nullptr;
+
+    N8Machine() { memset(&cpu, 0, sizeof(cpu)); memset(&desc, 0, sizeof(desc)); }
+    N8Machine(const N8Machine &) = delete;
+    N8Machine &operator=(const N8Machine &) = delete;
+};
+
+extern N8Machine n8_default;
+
+// The calling thread's machine.  __thread rather than thread_local: no
+// per-access initialisation check on the bus path.
+extern __thread N8Machine *n8;
+
+// New machine with the bus mapped, RAM and ROM clear and the CPU held in
+// reset; load code with emulator_write_mem() or emulator_loadrom().
+N8Machine *n8_machine_new();
+void       n8_machine_free(N8Machine *m);
+
+// Make m the calling thread's machine (nullptr: n8_default).  Returns the
+// previous one.
+N8Machine *n8_machine_bind(N8Machine *m);
+
+// Per-cycle check on the bus path, see emu_sched.h
+static inline void emu_sched_poll(uint64_t now) {
+    if (now >= n8->sched.due) emu_sched_run(now);
+}
@@ -1,5 +1,6 @@
 #include "doctest.h"
 #include "test_helpers.h"
+#include "n8_memory_map.h"
 
 TEST_SUITE("bus") {
 
@@ -12,7 +13,7 @@ TEST_SUITE("bus") {
         f.load_at(0xD000, {0xA9, 0x55, 0x8D, 0x00, 0x02});
         f.set_reset_vector(0xD000);
         f.step_n(20);
-        CHECK(mem[0x0200] == 0x55);
+        CHECK(n8->mem[0x0200] == 0x55);
     }
 
     // -------------------------------------------------------------------------
@@ -21,11 +22,11 @@ TEST_SUITE("bus") {
 
     TEST_CASE("T63: RAM read -- LDA $0200 loads value preset in mem[0x0200]") {
         EmulatorFixture f;
-        mem[0x0200] = 0xAA;
+        n8->mem[0x0200] = 0xAA;
         f.load_at(0xD000, {0xAD, 0x00, 0x02});
         f.set_reset_vector(0xD000);
         f.step_n(20);
-        CHECK(m6502_a(&cpu) == 0xAA);
+        CHECK(m6502_a(&n8->cpu) == 0xAA);
     }
 
     // -------------------------------------------------------------------------
@@ -37,7 +38,7 @@ TEST_SUITE("bus") {
         f.load_at(0xD000, {0xA9, 0x41, 0x8D, 0x00, 0xC0});
         f.set_reset_vector(0xD000);
         f.step_n(20);
-        CHECK(mem[0xC000] == 0x41);
+        CHECK(n8->mem[0xC000] == 0x41);
     }
 
     // -------------------------------------------------------------------------
@@ -46,11 +47,11 @@ TEST_SUITE("bus") {
 
     TEST_CASE("T65: Frame buffer read -- LDA $C000 loads value preset in mem[0xC000]") {
         EmulatorFixture f;
-        mem[0xC000] = 0x42;
+        n8->mem[0xC000] = 0x42;
         f.load_at(0xD000, {0xAD, 0x00, 0xC0});
         f.set_reset_vector(0xD000);
         f.step_n(20);
-        CHECK(m6502_a(&cpu) == 0x42);
+        CHECK(m6502_a(&n8->cpu) == 0x42);
     }
 
     // -------------------------------------------------------------------------
@@ -62,7 +63,7 @@ TEST_SUITE("bus") {
         f.load_at(0xD000, {0xA9, 0x7E, 0x8D, 0xFF, 0xC0});
         f.set_reset_vector(0xD000);
         f.step_n(20);
-        CHECK(mem[0xC0FF] == 0x7E);
+        CHECK(n8->mem[0xC0FF] == 0x7E);
     }
 
     // -------------------------------------------------------------------------
@@ -74,7 +75,91 @@ TEST_SUITE("bus") {
         f.load_at(0xD000, {0xA9, 0x33, 0x8D, 0x05, 0xC0});
         f.set_reset_vector(0xD000);
         f.step_n(20);
-        CHECK(mem[0xC005] == 0x33);
+        CHECK(n8->mem[0xC005] == 0x33);
+    }
+
+    // -------------------------------------------------------------------------
+    // T67a: ROM write protection
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T67a: ROM write protect -- STA $E000 leaves ROM unchanged, RAM still writable") {
+        EmulatorFixture f;
+        n8->mem[0xE000] = 0x11;
+        // LDA #$5A; STA $E000; STA $0300
+        f.load_at(0xD000, {0xA9, 0x5A, 0x8D, 0x00, 0xE0, 0x8D, 0x00, 0x03});
+        f.set_reset_vector(0xD000);
+        f.step_n(30);
+        CHECK(n8->mem[0xE000] == 0x11);
+        CHECK(n8->mem[0x0300] == 0x5A);
+    }
+
+    // -------------------------------------------------------------------------
+    // T67b: Device slot dispatch
+    // -------------------------------------------------------------------------
+
+    static uint8_t slot_last_reg = 0;
+    static uint8_t slot_last_write = 0;
+    static void test_slot_dev(uint64_t &pins, uint8_t reg) {
+        slot_last_reg = reg;
+        if (pins & M6502_RW) {
+            M6502_SET_DATA(pins, 0xA0 | reg);
+        } else {
+            slot_last_write = M6502_GET_DATA(pins);
+        }
+    }
+
+    TEST_CASE("T67b: Slot dispatch -- slot 5 ($D8A0) handler sees reg offset, neighbours read backing") {
+        EmulatorFixture f;
+        emulator_map_slot(5, test_slot_dev);
+        n8->mem[0xD8C0] = 0x77;  // slot 6, unmapped
+        // LDA $D8A3; STA $0300; LDA $D8C0; STA $0301; LDA #$99; STA $D8A7
+        f.load_at(0xD000, {0xAD, 0xA3, 0xD8, 0x8D, 0x00, 0x03,
+                           0xAD, 0xC0, 0xD8, 0x8D, 0x01, 0x03,
+                           0xA9, 0x99, 0x8D, 0xA7, 0xD8});
+        f.set_reset_vector(0xD000);
+        f.step_n(40);
+        CHECK(n8->mem[0x0300] == 0xA3);
+        CHECK(n8->mem[0x0301] == 0x77);
+        CHECK(slot_last_reg == 0x07);
+        CHECK(slot_last_write == 0x99);
+        emulator_map_slot(5, nullptr);
+    }
+
+    // -------------------------------------------------------------------------
+    // T67c: IRQ flags register at $D800, $00FF is plain RAM
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T67c: IRQ flags -- LDA $D800 reads the sources, STA $00FF is ordinary RAM") {
+        EmulatorFixture f;
+        emu_set_irq(N8_IRQ_BIT_TTY);
+        // SEI; LDA $D800; STA $0300; LDA #$5A; STA $00FF; STA $D800; LDA $D800; STA $0301
+        f.load_at(0xD000, {0x78, 0xAD, 0x00, 0xD8, 0x8D, 0x00, 0x03,
+                           0xA9, 0x5A, 0x85, 0xFF, 0x8D, 0x00, 0xD8,
+                           0xAD, 0x00, 0xD8, 0x8D, 0x01, 0x03});
+        f.set_reset_vector(0xD000);
+        f.step_n(50);
+        CHECK(n8->mem[0x0300] == 0x02);
+        CHECK(n8->mem[0x00FF] == 0x5A);
+        CHECK(n8->mem[0x0301] == 0x02);     // CPU writes don't touch the sources
+        CHECK(emu_irq_flags() == 0x02);
+    }
+
+    // -------------------------------------------------------------------------
+    // T67d: The IRQ pin follows the OR of the sources
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T67d: IRQ pin -- asserted while any source is high") {
+        EmulatorFixture f;
+        CHECK((n8->pins & M6502_IRQ) == 0);
+        emu_set_irq(N8_IRQ_BIT_TTY);
+        CHECK((n8->pins & M6502_IRQ) != 0);
+        emu_set_irq(N8_IRQ_BIT_KBD);
+        emu_clr_irq(N8_IRQ_BIT_TTY);
+        CHECK((n8->pins & M6502_IRQ) != 0);
+        CHECK(emu_irq_flags() == 0x04);
+        emu_clr_irq(N8_IRQ_BIT_KBD);
+        CHECK((n8->pins & M6502_IRQ) == 0);
+        CHECK(n8->mem[N8_IRQ_FLAGS] == 0x00);
     }
 
 } // TEST_SUITE("bus")
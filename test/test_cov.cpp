@@ -0,0 +1,185 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_cov.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+// D000: CLC; LDX #3
+// D003: DEX; BNE $D003         taken twice, then not
+// D006: BEQ $D009              always taken
+// D008: NOP                    never runs
+// D009: BCS $D00D              never taken
+// D00B: JMP $D00B
+void load_branches() {
+    const uint8_t prog[] = {0x18, 0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0xF0, 0x01,
+                            0xEA, 0xB0, 0x02, 0x4C, 0x0B, 0xD0};
+    for (size_t i = 0; i < sizeof(prog); i++) emulator_write_mem(0xD000 + i, prog[i]);
+    emulator_write_mem(0xFFFC, 0x00);
+    emulator_write_mem(0xFFFD, 0xD0);
+}
+
+std::string slurp(const char *path) {
+    std::string s;
+    FILE *fp = fopen(path, "r");
+    if (!fp) return s;
+    char buf[512];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) s.append(buf, n);
+    fclose(fp);
+    return s;
+}
+
+} // namespace
+
+TEST_SUITE("cov") {
+
+    // -------------------------------------------------------------------------
+    // T152: Executed instructions and branch outcomes
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T152: Coverage marks opcode fetches and both branch outcomes") {
+        std::vector<uint8_t> stepped;
+        for (int fast = 0; fast < 2; fast++) {
+            INFO("fast ", fast);
+            EmulatorFixture f;
+            emulator_enablefast(fast);
+            load_branches();
+            CHECK(emu_cov_hits() == nullptr);
+            emu_cov_enable(true);
+            REQUIRE(emu_cov_enabled());
+            emulator_run(2000, nullptr);
+
+            const uint8_t *h = emu_cov_hits();
+            CHECK(h[0xD000] == EMU_COV_EXEC);
+            CHECK(h[0xD001] == EMU_COV_EXEC);
+            CHECK(h[0xD002] == 0);
+            CHECK(h[0xD003] == EMU_COV_EXEC);
+            CHECK(h[0xD004] == (EMU_COV_EXEC | EMU_COV_TAKEN | EMU_COV_NOT_TAKEN));
+            CHECK(h[0xD006] == (EMU_COV_EXEC | EMU_COV_TAKEN));
+            CHECK(h[0xD008] == 0);
+            CHECK(h[0xD009] == (EMU_COV_EXEC | EMU_COV_NOT_TAKEN));
+            CHECK(h[0xD00B] == EMU_COV_EXEC);
+
+            std::vector<uint8_t> all(h, h + (1 << 16));
+            if (!fast) stepped = all;
+            else CHECK(all == stepped);
+
+            emu_cov_clear();
+            CHECK(h[0xD00B] == 0);
+            emulator_run(10, nullptr);
+            CHECK(h[0xD00B] == EMU_COV_EXEC);
+            CHECK(h[0xD000] == 0);
+            emu_cov_enable(false);
+            CHECK(emu_cov_hits() == nullptr);
+        }
+    }
+
+    TEST_CASE("T152a: Fast mode coverage survives a store over its own cached block") {
+        // 0300: LDA #$EA; STA $0310; JMP $0300 -- every STA drops the page's blocks
+        std::vector<uint8_t> stepped;
+        for (int fast = 0; fast < 2; fast++) {
+            INFO("fast ", fast);
+            EmulatorFixture f;
+            emulator_enablefast(fast);
+            const uint8_t prog[] = {0xA9, 0xEA, 0x8D, 0x10, 0x03, 0x4C, 0x00, 0x03};
+            for (size_t i = 0; i < sizeof(prog); i++) emulator_write_mem(0x0300 + i, prog[i]);
+            emulator_write_mem(0xFFFC, 0x00);
+            emulator_write_mem(0xFFFD, 0x03);
+            emu_cov_enable(true);
+            emulator_run(2000, nullptr);
+
+            const uint8_t *h = emu_cov_hits();
+            CHECK(n8->mem[0x0310] == 0xEA);
+            CHECK(h[0x0300] == EMU_COV_EXEC);
+            CHECK(h[0x0302] == EMU_COV_EXEC);
+            CHECK(h[0x0305] == EMU_COV_EXEC);
+            CHECK(h[0x0310] == 0);
+
+            std::vector<uint8_t> all(h, h + (1 << 16));
+            if (!fast) stepped = all;
+            else CHECK(all == stepped);
+            emu_cov_enable(false);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // T153: ld65 debug info to lcov
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T153: Debug info maps code to lines and lcov lists lines and branches") {
+        char dir[] = "/tmp/n8_cov_XXXXXX";
+        REQUIRE(mkdtemp(dir));
+        const std::string dbg = std::string(dir) + "/fw.dbg", info = std::string(dir) + "/fw.info";
+        FILE *fp = fopen(dbg.c_str(), "w");
+        REQUIRE(fp);
+        fputs("version\tmajor=2,minor=0\n"
+              "info\tcsym=0,file=2,lib=0,line=12,mod=1,scope=1,seg=2,span=9,sym=0,type=1\n"
+              "file\tid=0,name=\"main.s\",size=400,mtime=0x00000000,mod=0\n"
+              "file\tid=1,name=\"/src/lib,v2.s\",size=10,mtime=0x00000000,mod=0\n"
+              "seg\tid=0,name=\"CODE\",start=0x00D000,size=0x0010,addrsize=absolute,type=ro,oname=\"fw\",ooffs=0\n"
+              "seg\tid=1,name=\"RODATA\",start=0x00E000,size=0x0004,addrsize=absolute,type=ro,oname=\"fw\",ooffs=16\n"
+              "span\tid=0,seg=0,start=0,size=1\n"
+              "span\tid=1,seg=0,start=1,size=2\n"
+              "span\tid=2,seg=0,start=3,size=1\n"
+              "span\tid=3,seg=0,start=4,size=2\n"
+              "span\tid=4,seg=0,start=6,size=2\n"
+              "span\tid=5,seg=0,start=8,size=2\n"
+              "span\tid=6,seg=0,start=10,size=3\n"
+              "span\tid=7,seg=1,start=0,size=4,type=0\n"
+              "span\tid=8,seg=0,start=13,size=1\n"
+              "line\tid=0,file=0,line=3,span=0\n"
+              "line\tid=1,file=0,line=4,span=1\n"
+              "line\tid=2,file=0,line=2\n"
+              "line\tid=3,file=0,line=6,span=2\n"
+              "line\tid=4,file=0,line=7,span=3\n"
+              "line\tid=5,file=0,line=8,span=4\n"
+              "line\tid=6,file=0,line=9,span=5\n"
+              "line\tid=7,file=0,line=12,span=6+8\n"
+              "line\tid=8,file=0,line=14,span=7\n"
+              "line\tid=9,file=0,line=30,type=2,count=1,span=6\n"
+              "line\tid=10,file=1,line=1,span=8\n"
+              "type\tid=0,val=\"800120\"\n", fp);
+        fclose(fp);
+
+        emu_cov_map_t map;
+        CHECK_FALSE(emu_cov_load_dbg("/nonexistent/fw.dbg", map));
+        REQUIRE(emu_cov_load_dbg(dbg.c_str(), map));
+        REQUIRE(map.files.size() == 2);
+        CHECK(map.files[0] == std::string(dir) + "/main.s");
+        CHECK(map.files[1] == "/src/lib,v2.s");
+        CHECK(map.lines.size() == 9);       // no label-only, data or macro lines
+
+        // CLC; LDX; DEX; BNE (both ways); BEQ (taken); BMI (never ran);
+        // JMP and a NOP that only one caller reached
+        std::vector<uint8_t> mem(1 << 16, 0), hits(1 << 16, 0);
+        const uint8_t prog[] = {0x18, 0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0xF0, 0x02,
+                                0x30, 0x00, 0x4C, 0x0D, 0xD0, 0xEA};
+        for (size_t i = 0; i < sizeof(prog); i++) mem[0xD000 + i] = prog[i];
+        hits[0xD000] = hits[0xD001] = hits[0xD003] = hits[0xD00A] = EMU_COV_EXEC;
+        hits[0xD004] = EMU_COV_EXEC | EMU_COV_TAKEN | EMU_COV_NOT_TAKEN;
+        hits[0xD006] = EMU_COV_EXEC | EMU_COV_TAKEN;
+
+        REQUIRE(emu_cov_lcov(info.c_str(), map, hits.data(), mem.data()));
+        CHECK(slurp(info.c_str()) ==
+              "TN:\n"
+              "SF:" + std::string(dir) + "/main.s\n"
+              "DA:3,1\nDA:4,1\nDA:6,1\n"
+              "DA:7,1\nBRDA:7,0,0,1\nBRDA:7,0,1,1\n"
+              "DA:8,1\nBRDA:8,0,0,1\nBRDA:8,0,1,0\n"
+              "DA:9,0\nBRDA:9,0,0,-\nBRDA:9,0,1,-\n"
+              "DA:12,1\n"
+              "BRF:6\nBRH:3\nLF:7\nLH:6\nend_of_record\n"
+              "SF:/src/lib,v2.s\n"
+              "DA:1,0\n"
+              "BRF:0\nBRH:0\nLF:1\nLH:0\nend_of_record\n");
+        unlink(dbg.c_str());
+        unlink(info.c_str());
+        rmdir(dir);
+    }
+}
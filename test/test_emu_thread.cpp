@@ -0,0 +1,197 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_ring.h"
+#include "emu_thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Poll the published snapshot until pred() holds or ~2s pass.
+template <typename Pred>
+static const emu_snapshot_t* wait_snapshot(Pred pred) {
+    for (int i = 0; i < 2000; i++) {
+        const emu_snapshot_t* s = emu_thread_latest();
+        if (pred(*s)) return s;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return emu_thread_latest();
+}
+
+TEST_SUITE("emu_thread") {
+
+    // -------------------------------------------------------------------------
+    // T110: SPSC ring
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T110: emu_ring_t -- FIFO order, full and empty reporting") {
+        emu_ring_t<int, 4> ring;
+        int v = 0;
+        CHECK(ring.empty());
+        CHECK(ring.pop(v) == false);
+        for (int i = 0; i < 4; i++) CHECK(ring.push(i));
+        CHECK(ring.push(99) == false);
+        CHECK(ring.size() == 4);
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(ring.pop(v));
+            CHECK(v == i);
+        }
+        CHECK(ring.empty());
+        // Indices wrap past N
+        for (int i = 0; i < 10; i++) {
+            CHECK(ring.push(i));
+            REQUIRE(ring.pop(v));
+            CHECK(v == i);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // T111: Run on the emulation thread, observe through the snapshot
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T111: emulation thread runs the CPU and publishes memory writes") {
+        EmulatorFixture f;
+        // loop: INC $0200; JMP loop
+        f.load_at(0xD000, {0xEE, 0x00, 0x02, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+
+        emu_thread_start(nullptr);
+        CHECK(emu_thread_latest()->running == false);
+
+        emu_thread_post(EMU_CMD_RUN);
+        const emu_snapshot_t* s = wait_snapshot([](const emu_snapshot_t& s) {
+            return s.tick_count > 1000 && s.mem[0x0200] != 0;
+        });
+        CHECK(s->running == true);
+        CHECK(s->tick_count > 1000);
+        CHECK(s->mem[0x0200] != 0);
+
+        emu_thread_post(EMU_CMD_PAUSE);
+        s = wait_snapshot([](const emu_snapshot_t& s) { return !s.running; });
+        CHECK(s->running == false);
+        emu_thread_stop();
+    }
+
+    // -------------------------------------------------------------------------
+    // T112: Breakpoint commands
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T112: BP_SET via the command queue stops the thread at the breakpoint") {
+        EmulatorFixture f;
+        // NOP; NOP; NOP; JMP $D000
+        f.load_at(0xD000, {0xEA, 0xEA, 0xEA, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+
+        emu_thread_start(nullptr);
+        emu_thread_post(EMU_CMD_BP_SET, 0xD002);
+        emu_thread_post(EMU_CMD_BP_ENABLE, 0, 1);
+        emu_thread_post(EMU_CMD_RUN);
+        const emu_snapshot_t* s = wait_snapshot([](const emu_snapshot_t& s) {
+            return (s.dbg_flags[0xD002] & DBG_EXEC) && s.tick_count > 0 && !s.running;
+        });
+        CHECK((s->dbg_flags[0xD002] & DBG_EXEC) != 0);
+        CHECK(s->running == false);
+        CHECK(s->ci == 0xD002);
+        emu_thread_stop();
+    }
+    // -------------------------------------------------------------------------
+    // T113: Paced clock
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T113: 1 MHz pacing holds tick_count to wall time") {
+        EmulatorFixture f;
+        // loop: INC $0200; JMP loop
+        f.load_at(0xD000, {0xEE, 0x00, 0x02, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+
+        emu_thread_start(nullptr);
+        emu_thread_post(EMU_CMD_PACE, 0, EMU_PACE_1MHZ);
+        emu_thread_post(EMU_CMD_RUN);
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        emu_thread_post(EMU_CMD_PAUSE);
+        const emu_snapshot_t* s = wait_snapshot([](const emu_snapshot_t& s) { return !s.running; });
+        CHECK(s->target_hz == 1000000);
+        // ~300k ticks; generous bounds for a loaded host, but far below
+        // what an unpaced run reaches in the same time
+        CHECK(s->tick_count > 100000);
+        CHECK(s->tick_count < 450000);
+
+        emu_thread_post(EMU_CMD_PACE, 0, EMU_PACE_UNLIMITED);
+        s = wait_snapshot([](const emu_snapshot_t& s) { return s.target_hz == 0; });
+        CHECK(s->target_hz == 0);
+        emu_thread_stop();
+    }
+
+    // -------------------------------------------------------------------------
+    // T154: Free-run chunk sizing
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T154: Free runs check the clock less often, breakpoints still stop exactly") {
+        EmulatorFixture f;
+        // loop: INC $0200; JMP loop
+        f.load_at(0xD000, {0xEE, 0x00, 0x02, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+        emulator_enablefast(true);
+
+        emu_thread_start(nullptr);
+        CHECK(emu_thread_latest()->chunk_ticks == 1000);
+        emu_thread_post(EMU_CMD_RUN);
+        // Fast mode manages well over 10 MHz even unoptimised: 100us > 1000 ticks
+        const emu_snapshot_t* s = wait_snapshot([](const emu_snapshot_t& s) {
+            return s.chunk_ticks > 1000;
+        });
+        CHECK(s->chunk_ticks > 1000);
+        CHECK(s->chunk_ticks <= 65536);
+
+        // Breakpoint armed mid-run, with a large chunk in flight
+        emu_thread_post(EMU_CMD_BP_SET, 0xD003);
+        emu_thread_post(EMU_CMD_BP_ENABLE, 0, 1);
+        s = wait_snapshot([](const emu_snapshot_t& s) { return !s.running; });
+        CHECK(s->running == false);
+        CHECK(s->ci == 0xD003);
+        emu_thread_stop();
+        emulator_enablefast(false);
+    }
+
+    // -------------------------------------------------------------------------
+    // T155: GUI wake hook
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T155: The wake hook fires on changes, not while the CPU sits halted") {
+        static std::atomic<int> wakes{0};
+        EmulatorFixture f;
+        // NOP; NOP; NOP; JMP $D000
+        f.load_at(0xD000, {0xEA, 0xEA, 0xEA, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+
+        wakes = 0;
+        emu_thread_set_wake([]() { wakes++; });
+        emu_thread_start(nullptr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        CHECK(wakes == 0);          // halted, periodic publishes only
+
+        emu_thread_post(EMU_CMD_BP_SET, 0xD002);
+        emu_thread_post(EMU_CMD_BP_ENABLE, 0, 1);
+        emu_thread_post(EMU_CMD_RUN);
+        const emu_snapshot_t* s = wait_snapshot([](const emu_snapshot_t& s) {
+            return s.tick_count > 0 && !s.running;
+        });
+        REQUIRE(s->ci == 0xD002);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const int at_stop = wakes;
+        CHECK(at_stop >= 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        CHECK(wakes == at_stop);
+
+        emu_thread_trace_request();
+        uint64_t tick;
+        for (int i = 0; i < 2000 && !emu_thread_trace_copy(&tick); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CHECK(wakes > at_stop);     // the copy is in
+
+        emu_thread_stop();
+        emu_thread_set_wake(nullptr);
+    }
+}
@@ -0,0 +1,297 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_fast6502.h"
+#include "n8_memory_map.h"
+
+// Lockstep cross-checks: the same instruction, from the same state, run
+// through m6502_tick (emulator_step until SYNC) and through the fast
+// interpreter (emulator_fast_step) must leave identical machine state.
+
+namespace {
+
+struct MachineState {
+    m6502_t cpu;
+    uint64_t pins;
+    uint64_t ticks;
+    std::vector<uint8_t> ram;
+
+    void save() {
+        cpu = n8->cpu;
+        pins = n8->pins;
+        ticks = n8->tick_count;
+        ram.assign(n8->mem, n8->mem + 65536);
+    }
+    void restore() const {
+        n8->cpu = cpu;
+        n8->pins = pins;
+        n8->tick_count = ticks;
+        memcpy(n8->mem, ram.data(), 65536);
+        emulator_idle_reset();
+    }
+};
+
+// Registers, PC, cycle count and memory must all agree
+void check_same(const MachineState& ref, const char* what) {
+    INFO(what);
+    CHECK(m6502_a(&n8->cpu) == ref.cpu.A);
+    CHECK(m6502_x(&n8->cpu) == ref.cpu.X);
+    CHECK(m6502_y(&n8->cpu) == ref.cpu.Y);
+    CHECK(m6502_s(&n8->cpu) == ref.cpu.S);
+    CHECK(m6502_p(&n8->cpu) == ref.cpu.P);
+    CHECK(m6502_pc(&n8->cpu) == ref.cpu.PC);
+    CHECK(M6502_GET_ADDR(n8->pins) == M6502_GET_ADDR(ref.pins));
+    CHECK(n8->tick_count == ref.ticks);
+    CHECK(memcmp(n8->mem, ref.ram.data(), 65536) == 0);
+}
+
+// Run one instruction on the tick core; false if it never reached SYNC
+bool tick_instruction() {
+    for (int i = 0; i < 16; i++) {
+        emulator_step();
+        if (n8->pins & M6502_SYNC) return true;
+    }
+    return false;
+}
+
+uint32_t rng_state = 0x12345678;
+uint8_t rnd() {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (uint8_t)(rng_state >> 16);
+}
+
+} // namespace
+
+TEST_SUITE("fast6502") {
+
+    // -------------------------------------------------------------------------
+    // T120: Every opcode the fast path accepts matches the tick core
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T120: Random per-opcode lockstep -- fast path matches m6502_tick") {
+        EmulatorFixture f;
+        MachineState start, ref;
+        int accepted[256] = {0};
+
+        for (int op = 0; op < 256; op++) {
+            for (int trial = 0; trial < 48; trial++) {
+                // Instruction somewhere in RAM, random operands and data
+                const uint16_t at = 0x0400 + ((rnd() << 8 | rnd()) % 0xB000);
+                n8->mem[at] = (uint8_t)op;
+                n8->mem[(uint16_t)(at + 1)] = rnd();
+                n8->mem[(uint16_t)(at + 2)] = rnd();
+                for (int i = 0; i < 256; i++) n8->mem[i] = rnd();            // pointers
+                for (int i = 0x100; i < 0x200; i++) n8->mem[i] = rnd();      // stack
+                for (int i = 0; i < 8; i++) n8->mem[(rnd() << 8 | rnd())] = rnd();
+
+                emulator_write_pc(at);
+                n8->pins &= ~(M6502_IRQ | M6502_RES);
+                n8->cpu.PINS = n8->pins;
+                n8->cpu.irq_pip = n8->cpu.nmi_pip = 0;
+                n8->cpu.brk_flags = 0;
+                m6502_set_a(&n8->cpu, rnd());
+                m6502_set_x(&n8->cpu, rnd());
+                m6502_set_y(&n8->cpu, rnd());
+                m6502_set_s(&n8->cpu, rnd());
+                m6502_set_p(&n8->cpu, (rnd() & ~M6502_XF) | M6502_BF);
+                start.save();
+
+                if (!emulator_fast_step()) {
+                    // Declined: nothing may have changed
+                    MachineState now;
+                    now.save();
+                    CHECK(memcmp(&now.cpu, &start.cpu, sizeof(m6502_t)) == 0);
+                    CHECK(now.pins == start.pins);
+                    CHECK(now.ticks == start.ticks);
+                    continue;
+                }
+                accepted[op]++;
+                MachineState fast;
+                fast.save();
+
+                start.restore();
+                REQUIRE(tick_instruction());
+                ref.save();
+                fast.restore();
+                INFO("opcode ", op, " at ", at);
+                check_same(ref, "opcode");
+            }
+        }
+
+        // Spot check the coverage: common opcodes run fast, BRK/CLI/SEI/PLP/RTI never do
+        CHECK(accepted[0xA9] > 0);
+        CHECK(accepted[0x6D] > 0);
+        CHECK(accepted[0x20] > 0);
+        CHECK(accepted[0xD0] > 0);
+        CHECK(accepted[0x00] == 0);
+        CHECK(accepted[0x58] == 0);
+        CHECK(accepted[0x78] == 0);
+        CHECK(accepted[0x28] == 0);
+        CHECK(accepted[0x40] == 0);
+    }
+
+    // -------------------------------------------------------------------------
+    // T121: A whole program in fast mode ends in the same state
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T121: Program lockstep -- emulator_run fast vs tick core") {
+        EmulatorFixture f;
+        // D000: LDX #$00
+        // D002: TXA; STA $0300,X; ADC $0300,X; STA $0400,Y; INY; JSR $D080
+        // D00E: LDA $C102 (TTY, via bus); SED; ADC #$19; CLD; PHA; PLA
+        // D018: INX; BNE $D002; JMP ($0010)
+        // D080: CLI; SEI; INC $00F0; RTS
+        f.load_at(0xD000, {0xA2, 0x00,
+                           0x8A, 0x9D, 0x00, 0x03, 0x7D, 0x00, 0x03, 0x99, 0x00, 0x04, 0xC8,
+                           0x20, 0x80, 0xD0,
+                           0xAD, 0x02, 0xC1, 0xF8, 0x69, 0x19, 0xD8, 0x48, 0x68,
+                           0xE8, 0xD0, 0xE6, 0x6C, 0x10, 0x00});
+        f.load_at(0xD080, {0x58, 0x78, 0xEE, 0xF0, 0x00, 0x60});
+        n8->mem[0x0010] = 0x00;
+        n8->mem[0x0011] = 0xD0;
+        f.set_reset_vector(0xD000);
+        f.step_n(10);   // through the reset sequence
+
+        MachineState start, ref;
+        start.save();
+
+        emulator_run(200000, nullptr);
+        ref.save();
+
+        start.restore();
+        emulator_enablefast(true);
+        emulator_run(200000, nullptr);
+        emulator_enablefast(false);
+        check_same(ref, "after 200000 ticks");
+    }
+
+    // -------------------------------------------------------------------------
+    // T122: Breakpoints still fire in fast mode
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T122: Fast mode stops at a breakpoint with the tick core's cycle count") {
+        EmulatorFixture f;
+        // D000: INX; INY; JMP $D000 -- BP on a separate page is reached by JMP
+        f.load_at(0xD000, {0xE8, 0xC8, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+        f.step_n(10);
+        n8->mem[0xD002] = 0x4C; n8->mem[0xD003] = 0x00; n8->mem[0xD004] = 0xD1;
+        f.load_at(0xD100, {0xEA, 0x4C, 0x00, 0xD0});
+        emulator_dbg_set(0xD101, DBG_EXEC);
+        emulator_enablebp(true);
+
+        MachineState start, ref;
+        start.save();
+        emu_stop_reason_t reason;
+        emulator_run(10000, &reason);
+        CHECK(reason == EMU_STOP_BREAKPOINT);
+        ref.save();
+        emulator_clear_bp_hit();
+
+        start.restore();
+        emulator_enablefast(true);
+        emulator_run(10000, &reason);
+        emulator_enablefast(false);
+        CHECK(reason == EMU_STOP_BREAKPOINT);
+        emulator_clear_bp_hit();
+        check_same(ref, "at breakpoint");
+    }
+
+    // -------------------------------------------------------------------------
+    // T123: ROM block cache -- lockstep, and invalidated by debugger writes
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T123: ROM basic blocks match the tick core and see emulator_write_mem") {
+        EmulatorFixture f;
+        // D000: LDX #$00
+        // D002: INX; STX $0200; INC $0201; CPX #$40; BNE $D002
+        // D00C: LDA #$11; STA $0202; JMP $D000
+        f.load_at(0xD000, {0xA2, 0x00,
+                           0xE8, 0x8E, 0x00, 0x02, 0xEE, 0x01, 0x02, 0xE0, 0x40, 0xD0, 0xF5,
+                           0xA9, 0x11, 0x8D, 0x02, 0x02, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+        f.step_n(10);
+
+        MachineState start, ref;
+        start.save();
+        emulator_run(5000, nullptr);
+        emulator_write_mem(0xD00E, 0x22);
+        emulator_run(5001, nullptr);
+        ref.save();
+        CHECK(n8->mem[0x0202] == 0x22);
+
+        start.restore();
+        emulator_enablefast(true);
+        emulator_run(5000, nullptr);
+        CHECK(n8->mem[0x0202] == 0x11);
+        emulator_write_mem(0xD00E, 0x22);      // ROM page: drops its cached blocks
+        emulator_run(5001, nullptr);
+        emulator_enablefast(false);
+        check_same(ref, "after ROM patch");
+    }
+
+    // -------------------------------------------------------------------------
+    // T124: Differential fuzz -- random memory images, block chaining on
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T124: Random programs run the same through cached blocks and m6502_tick") {
+        EmulatorFixture f;
+        emulator_map_page(N8_LEGACY_TTY_BASE >> 8, nullptr, false);   // no console output
+        MachineState start, ref;
+
+        for (int trial = 0; trial < 64; trial++) {
+            // Code, data, pointers and vectors are all random; JAMs would
+            // just park both cores, so make them NOPs
+            for (int i = 0; i < 65536; i++) {
+                uint8_t b = rnd();
+                if ((b & 0x0F) == 0x02 && b != 0xA2 && b != 0xC2 && b != 0xE2) b = 0xEA;
+                n8->mem[i] = b;
+            }
+            emu_fast6502_flush();
+
+            emulator_write_pc(0x0400 + ((rnd() << 8 | rnd()) % 0xB000));
+            n8->pins &= ~(M6502_IRQ | M6502_RES);
+            n8->cpu.PINS = n8->pins;
+            n8->cpu.irq_pip = n8->cpu.nmi_pip = 0;
+            n8->cpu.brk_flags = 0;
+            m6502_set_s(&n8->cpu, rnd());
+            m6502_set_p(&n8->cpu, (rnd() & ~M6502_XF) | M6502_BF);
+            start.save();
+
+            emulator_run(20000, nullptr);
+            ref.save();
+
+            start.restore();
+            emu_fast6502_flush();
+            emulator_enablefast(true);
+            emulator_run(20000, nullptr);
+            emulator_enablefast(false);
+            INFO("trial ", trial);
+            check_same(ref, "after 20000 ticks");
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // T125: Self-modifying code in RAM
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T125: A store into cached code is seen by the next pass") {
+        EmulatorFixture f;
+        // 0400: LDA #$5A; STA $0300; INC $0403 (STA's address); JMP $0400
+        f.load_at(0x0400, {0xA9, 0x5A, 0x8D, 0x00, 0x03, 0xEE, 0x03, 0x04, 0x4C, 0x00, 0x04});
+        f.set_reset_vector(0x0400);
+        f.step_n(10);
+
+        MachineState start, ref;
+        start.save();
+        emulator_run(3000, nullptr);
+        ref.save();
+        CHECK(n8->mem[0x0300] == 0x5A);
+        CHECK(n8->mem[0x0340] == 0x5A);
+
+        start.restore();
+        emulator_enablefast(true);
+        emulator_run(3000, nullptr);
+        emulator_enablefast(false);
+        check_same(ref, "after 3000 ticks");
+    }
+}
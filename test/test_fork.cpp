@@ -0,0 +1,80 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_fork.h"
+
+#include <sys/wait.h>
+
+namespace {
+
+// D000: loop: LDA $C102; BEQ loop; LDA $C103; STA $C101; JMP loop
+// TTY echo, polled (I is still set from reset)
+void load_echo() {
+    const uint8_t prog[] = {0xAD, 0x02, 0xC1, 0xF0, 0xFB, 0xAD, 0x03, 0xC1,
+                            0x8D, 0x01, 0xC1, 0x4C, 0x00, 0xD0};
+    for (size_t i = 0; i < sizeof(prog); i++) emulator_write_mem(0xD000 + i, prog[i]);
+    emulator_write_mem(0xFFFC, 0x00);
+    emulator_write_mem(0xFFFD, 0xD0);
+}
+
+} // namespace
+
+TEST_SUITE("fork") {
+
+    // -------------------------------------------------------------------------
+    // T134: Fan-out children run from the parent's state, parent untouched
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T134: Forked variants echo their own input and report back") {
+        EmulatorFixture f;
+        load_echo();
+        emulator_run(1000, nullptr);
+        const uint64_t booted = emulator_ticks();
+
+        std::vector<std::string> inputs = {"hello\r", "", "xyz"};
+        std::vector<emu_fork_result_t> results;
+        CHECK(emu_fork_run(inputs, 20000, 2, results));
+        REQUIRE(results.size() == 3);
+        for (size_t i = 0; i < results.size(); i++) {
+            INFO("variant ", i);
+            CHECK(results[i].input == inputs[i]);
+            CHECK(results[i].output == inputs[i]);
+            CHECK(results[i].reason == EMU_STOP_CYCLES);
+            CHECK(results[i].cycles == 20000);
+            CHECK(WIFEXITED(results[i].status));
+            CHECK(WEXITSTATUS(results[i].status) == 0);
+        }
+        CHECK(emulator_ticks() == booted);
+        CHECK(tty_buff_count() == 0);
+
+        // Breakpoint on the STA: each child stops before echoing anything
+        emulator_dbg_set(0xD008, DBG_EXEC);
+        emulator_enablebp(true);
+        inputs = {"a"};
+        CHECK(emu_fork_run(inputs, 20000, 0, results));
+        REQUIRE(results.size() == 1);
+        CHECK(results[0].reason == EMU_STOP_BREAKPOINT);
+        CHECK(results[0].cycles < 20000);
+        CHECK(results[0].output.empty());
+        emulator_dbg_clear(0xD008, DBG_EXEC);
+        emulator_enablebp(false);
+
+        // Host input pending at the fork stays with the parent
+        for (const char *p = "junk"; *p; p++) n8->tty.rx_ring.push((uint8_t)*p);
+        n8->tty.rx_pending.store(true);
+        tty_poll(emulator_ticks());
+        REQUIRE(emu_sched_booked(EMU_EV_TTY_RX));
+        inputs = {"ok"};
+        CHECK(emu_fork_run(inputs, 20000, 0, results));
+        REQUIRE(results.size() == 1);
+        CHECK(results[0].output == "ok");
+        CHECK(n8->tty.rx_ring.size() == 4);
+        tty_drop_host_input();
+        CHECK(n8->tty.rx_ring.empty());
+        CHECK_FALSE(emu_sched_booked(EMU_EV_TTY_RX));
+
+        // No cycle limit: refused, nothing forked
+        CHECK_FALSE(emu_fork_run(inputs, 0, 0, results));
+        CHECK(results.empty());
+        CHECK(emulator_ticks() == booted);
+    }
+}
@@ -76,7 +76,7 @@ TEST_SUITE("gdb_callbacks") {
         f.load_at(0xD000, {0xEA});
         f.step_n(10);
         emulator_write_pc(0xD100);
-        CHECK((pins & M6502_SYNC) != 0);
+        CHECK((n8->pins & M6502_SYNC) != 0);
     }
 
     TEST_CASE("PC write preserves IRQ pin") {
@@ -84,9 +84,9 @@ TEST_SUITE("gdb_callbacks") {
         f.set_reset_vector(0xD000);
         f.load_at(0xD000, {0xEA});
         f.step_n(10);
-        pins |= M6502_IRQ;
+        n8->pins |= M6502_IRQ;
         emulator_write_pc(0xD100);
-        CHECK((pins & M6502_IRQ) != 0);
+        CHECK((n8->pins & M6502_IRQ) != 0);
     }
 
     TEST_CASE("PC write preserves NMI pin") {
@@ -94,35 +94,35 @@ TEST_SUITE("gdb_callbacks") {
         f.set_reset_vector(0xD000);
         f.load_at(0xD000, {0xEA});
         f.step_n(10);
-        pins |= M6502_NMI;
+        n8->pins |= M6502_NMI;
         emulator_write_pc(0xD100);
-        CHECK((pins & M6502_NMI) != 0);
+        CHECK((n8->pins & M6502_NMI) != 0);
     }
 
     // ---- Memory read (direct mem[] access) ----
 
     TEST_CASE("Memory read returns mem[] directly") {
         EmulatorFixture f;
-        mem[0x0200] = 0xAB;
-        CHECK(mem[0x0200] == 0xAB);
+        n8->mem[0x0200] = 0xAB;
+        CHECK(n8->mem[0x0200] == 0xAB);
     }
 
     TEST_CASE("Memory read of TTY region returns mem[], not device state") {
         EmulatorFixture f;
-        mem[0xC100] = 0x55;
-        CHECK(mem[0xC100] == 0x55);
+        n8->mem[0xC100] = 0x55;
+        CHECK(n8->mem[0xC100] == 0x55);
     }
 
     TEST_CASE("Memory write to RAM") {
         EmulatorFixture f;
-        mem[0x0200] = 0xCD;
-        CHECK(mem[0x0200] == 0xCD);
+        n8->mem[0x0200] = 0xCD;
+        CHECK(n8->mem[0x0200] == 0xCD);
     }
 
     TEST_CASE("Memory write to ROM area") {
         EmulatorFixture f;
-        mem[0xD000] = 0xEA;
-        CHECK(mem[0xD000] == 0xEA);
+        n8->mem[0xD000] = 0xEA;
+        CHECK(n8->mem[0xD000] == 0xEA);
     }
 
     // ---- Step instruction via SYNC loop ----
@@ -155,10 +155,10 @@ TEST_SUITE("gdb_callbacks") {
         f.set_reset_vector(0xD000);
         // LDA $0200; NOP
         f.load_at(0xD000, {0xAD, 0x00, 0x02, 0xEA});
-        mem[0x0200] = 0x42;
+        n8->mem[0x0200] = 0x42;
 
         // Set breakpoint at data address 0x0200
-        bp_mask[0x0200] = true;
+        emulator_dbg_set(0x0200, DBG_EXEC);
         emulator_enablebp(true);
 
         f.step_n(20); // run through the LDA instruction
@@ -173,7 +173,7 @@ TEST_SUITE("gdb_callbacks") {
         // NOP at 0xD000; NOP at 0xD001
         f.load_at(0xD000, {0xEA, 0xEA});
 
-        bp_mask[0xD001] = true;
+        emulator_dbg_set(0xD001, DBG_EXEC);
         emulator_enablebp(true);
 
         f.step_n(15); // boot + execute first NOP, reach 0xD001
@@ -225,7 +225,7 @@ TEST_SUITE("gdb_callbacks") {
         f.set_reset_vector(0xD000);
         f.load_at(0xD000, {0xEA, 0xEA});
 
-        bp_mask[0xD000] = true;
+        emulator_dbg_set(0xD000, DBG_EXEC);
         emulator_enablebp(true);
 
         f.step_n(10); // boot triggers bp at D000
@@ -260,7 +260,7 @@ TEST_SUITE("gdb_callbacks") {
         CHECK(tty_buff_count() == 1);
 
         // Read TTY address via mem[] directly (as GDB would)
-        uint8_t val = mem[0xC103];
+        uint8_t val = n8->mem[0xC103];
         (void)val; // ignore value
 
         CHECK(tty_buff_count() == 1); // queue untouched
@@ -279,10 +279,10 @@ TEST_SUITE("gdb_callbacks") {
         do {
             emulator_step();
             ticks++;
-        } while (!(pins & M6502_SYNC) && ticks < 16);
+        } while (!(n8->pins & M6502_SYNC) && ticks < 16);
 
         CHECK(ticks <= 16);
-        CHECK((pins & M6502_SYNC) != 0);
+        CHECK((n8->pins & M6502_SYNC) != 0);
         // NOP should complete within 16 ticks → SIGTRAP
         int sig = (ticks >= 16) ? 4 : 5;
         CHECK(sig == 5);
@@ -299,7 +299,7 @@ TEST_SUITE("gdb_callbacks") {
         do {
             emulator_step();
             ticks++;
-        } while (!(pins & M6502_SYNC) && ticks < 16);
+        } while (!(n8->pins & M6502_SYNC) && ticks < 16);
 
         int sig = (ticks >= 16) ? 4 : 5;
         CHECK(sig == 4);
@@ -313,46 +313,46 @@ TEST_SUITE("gdb_callbacks") {
         f.load_at(0xD000, {0xEA});
         f.step_n(10);
 
-        pins |= M6502_RES;
+        n8->pins |= M6502_RES;
         tty_reset();
 
         // RES pin is set — stepping should initiate reset sequence
-        CHECK((pins & M6502_RES) != 0);
+        CHECK((n8->pins & M6502_RES) != 0);
     }
 
-    // ---- Phase 2: set/clear breakpoint via bp_mask[] ----
+    // ---- Phase 2: set/clear breakpoint via dbg_flags[] ----
 
-    TEST_CASE("set_breakpoint enables bp_mask at address") {
+    TEST_CASE("set_breakpoint sets DBG_EXEC at address") {
         EmulatorFixture f;
-        bp_mask[0xD100] = false;
-        bp_mask[0xD100] = true;
-        CHECK(bp_mask[0xD100] == true);
+        emulator_dbg_clear(0xD100, DBG_EXEC);
+        emulator_dbg_set(0xD100, DBG_EXEC);
+        CHECK((n8->dbg_flags[0xD100] & DBG_EXEC) != 0);
     }
 
-    TEST_CASE("clear_breakpoint clears bp_mask at address") {
+    TEST_CASE("clear_breakpoint clears DBG_EXEC at address") {
         EmulatorFixture f;
-        bp_mask[0xD100] = true;
-        bp_mask[0xD100] = false;
-        CHECK(bp_mask[0xD100] == false);
+        emulator_dbg_set(0xD100, DBG_EXEC);
+        emulator_dbg_clear(0xD100, DBG_EXEC);
+        CHECK((n8->dbg_flags[0xD100] & DBG_EXEC) == 0);
     }
 
     // ---- Phase 2: D44 — clearing all breakpoints on disconnect ----
 
-    TEST_CASE("D44: clearing all breakpoints resets bp_mask") {
+    TEST_CASE("D44: clearing all breakpoints resets DBG_EXEC flags") {
         EmulatorFixture f;
         // Set several breakpoints
-        bp_mask[0xD000] = true;
-        bp_mask[0xD010] = true;
-        bp_mask[0xD020] = true;
+        emulator_dbg_set(0xD000, DBG_EXEC);
+        emulator_dbg_set(0xD010, DBG_EXEC);
+        emulator_dbg_set(0xD020, DBG_EXEC);
         emulator_enablebp(true);
 
         // Simulate disconnect: clear all
-        memset(bp_mask, 0, sizeof(bool) * 65536);
+        emulator_dbg_clear_all(DBG_EXEC);
         emulator_enablebp(false);
 
-        CHECK(bp_mask[0xD000] == false);
-        CHECK(bp_mask[0xD010] == false);
-        CHECK(bp_mask[0xD020] == false);
+        CHECK((n8->dbg_flags[0xD000] & DBG_EXEC) == 0);
+        CHECK((n8->dbg_flags[0xD010] & DBG_EXEC) == 0);
+        CHECK((n8->dbg_flags[0xD020] & DBG_EXEC) == 0);
         CHECK(emulator_bp_enabled() == false);
     }
 
@@ -363,7 +363,7 @@ TEST_SUITE("gdb_callbacks") {
         f.set_reset_vector(0xD000);
         // LDA #$42; STA $0200; NOP
         f.load_at(0xD000, {0xA9, 0x42, 0x8D, 0x00, 0x02, 0xEA});
-        wp_write_mask[0x0200] = true;
+        emulator_dbg_set(0x0200, DBG_WRITE);
         emulator_enablewp(true);
 
         f.step_n(20); // boot + execute LDA + STA
@@ -378,8 +378,8 @@ TEST_SUITE("gdb_callbacks") {
         f.set_reset_vector(0xD000);
         // LDA $0200; NOP
         f.load_at(0xD000, {0xAD, 0x00, 0x02, 0xEA});
-        mem[0x0200] = 0x42;
-        wp_read_mask[0x0200] = true;
+        n8->mem[0x0200] = 0x42;
+        emulator_dbg_set(0x0200, DBG_READ);
         emulator_enablewp(true);
 
         f.step_n(20);
@@ -399,7 +399,7 @@ TEST_SUITE("gdb_callbacks") {
         emulator_write_pc(0xD000);
 
         // Set read watchpoint at opcode address and clear residual state
-        wp_read_mask[0xD000] = true;
+        emulator_dbg_set(0xD000, DBG_READ);
         emulator_enablewp(true);
         emulator_clear_wp_hit();
 
@@ -420,7 +420,7 @@ TEST_SUITE("gdb_callbacks") {
         // Trigger a write watchpoint
         f.set_reset_vector(0xD000);
         f.load_at(0xD000, {0x8D, 0x00, 0x03, 0xEA}); // STA $0300; NOP
-        wp_write_mask[0x0300] = true;
+        emulator_dbg_set(0x0300, DBG_WRITE);
         f.step_n(20);
 
         CHECK(emulator_wp_hit() == true);
@@ -430,17 +430,17 @@ TEST_SUITE("gdb_callbacks") {
 
     TEST_CASE("D44 extension: disconnect clears watchpoint masks") {
         EmulatorFixture f;
-        wp_write_mask[0x0200] = true;
-        wp_read_mask[0x0300] = true;
+        emulator_dbg_set(0x0200, DBG_WRITE);
+        emulator_dbg_set(0x0300, DBG_READ);
         emulator_enablewp(true);
 
         // Simulate disconnect
-        memset(wp_write_mask, 0, sizeof(bool) * 65536);
-        memset(wp_read_mask, 0, sizeof(bool) * 65536);
+        emulator_dbg_clear_all(DBG_WRITE);
+        emulator_dbg_clear_all(DBG_READ);
         emulator_enablewp(false);
 
-        CHECK(wp_write_mask[0x0200] == false);
-        CHECK(wp_read_mask[0x0300] == false);
+        CHECK((n8->dbg_flags[0x0200] & DBG_WRITE) == 0);
+        CHECK((n8->dbg_flags[0x0300] & DBG_READ) == 0);
         CHECK(emulator_wp_enabled() == false);
     }
 
@@ -740,4 +740,38 @@ TEST_SUITE("gdb_protocol") {
         CHECK(gdb_stub_last_signal() == 2); // SIGINT
     }
 
+    // -------------------------------------------------------------------------
+    // T138: bs / bc -- reverse step and continue
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T138: bs/bc report stops, the start of history and watch hits") {
+        GdbProtocolFixture f;
+        CHECK(gdb_stub_process_packet("bs") == "");     // no reverse callbacks
+        CHECK(gdb_stub_process_packet("qSupported").find("ReverseStep+") == std::string::npos);
+
+        static int rev_result;
+        static int rev_wp_type;
+        gdb_stub_callbacks_t cb = mock_cb;
+        cb.reverse_step = []() { return rev_result; };
+        cb.reverse_continue = [](uint16_t* addr, int* type) {
+            *addr = 0x0012;
+            *type = rev_wp_type;
+            return rev_result;
+        };
+        gdb_stub_set_callbacks(&cb);
+        CHECK(gdb_stub_process_packet("qSupported").find("ReverseStep+;ReverseContinue+") != std::string::npos);
+
+        rev_result = 5;
+        rev_wp_type = 0;
+        CHECK(gdb_stub_process_packet("bs") == "T05thread:01;");
+        CHECK(gdb_stub_process_packet("bc") == "T05thread:01;");
+        rev_wp_type = 2;
+        CHECK(gdb_stub_process_packet("bc") == "T05watch:1200;thread:01;");
+        rev_result = 0;
+        CHECK(gdb_stub_process_packet("bs") == "T05replaylog:begin;thread:01;");
+        CHECK(gdb_stub_process_packet("bx") == "");
+        CHECK(gdb_stub_last_signal() == 5);
+        gdb_stub_set_callbacks(&mock_cb);
+    }
+
 } // TEST_SUITE("gdb_protocol")
@@ -0,0 +1,92 @@
+#include "doctest.h"
+#include "gui_idle.h"
+
+#include <deque>
+
+namespace {
+
+enum { EV_WAKE, EV_INPUT };
+
+// Stands in for the SDL queue and main.cpp's loop around it
+struct gui_queue_t {
+    gui_idle_t idle;
+    std::deque<int> events;
+    int wakes = 0;          // wake events handled
+
+    void wake() {
+        if (gui_idle_wake(idle)) events.push_back(EV_WAKE);
+    }
+
+    // Wait (one event), then drain the rest, as a frame does
+    void frame(uint32_t now) {
+        bool have_event = !events.empty();
+        int event = have_event ? events.front() : -1;
+        if (have_event) events.pop_front();
+        gui_idle_frame(idle, now);
+        while (have_event || !events.empty()) {
+            if (!have_event) { event = events.front(); events.pop_front(); }
+            have_event = false;
+            gui_idle_event(idle, event == EV_WAKE);
+            wakes += event == EV_WAKE;
+        }
+    }
+};
+
+} // namespace
+
+TEST_SUITE("gui_idle") {
+
+    // -------------------------------------------------------------------------
+    // T156: GUI wake events
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T156: A wake queued behind input is handled and later wakes still queue") {
+        gui_queue_t q;
+        q.events.push_back(EV_INPUT);
+        q.wake();
+        q.wake();                               // already queued
+        CHECK(q.events.size() == 2);
+
+        q.frame(0);                             // waits on the input, drains the wake
+        CHECK(q.wakes == 1);
+        CHECK(q.events.empty());
+
+        for (int i = 1; i <= 3; i++) {
+            q.wake();
+            REQUIRE(q.events.size() == 1);
+            q.frame(i * 100);
+            CHECK(q.wakes == 1 + i);
+        }
+    }
+
+    TEST_CASE("T156a: A wake raised between the wait and the drain isn't lost") {
+        gui_queue_t q;
+        q.wake();
+        q.frame(0);
+        // The next wake arrives after gui_idle_frame(), before the queue is
+        // empty again: it stays queued for the next frame
+        gui_idle_frame(q.idle, 10);
+        q.wake();
+        REQUIRE(q.events.size() == 1);
+        q.frame(20);
+        CHECK(q.wakes == 2);
+        q.wake();
+        CHECK(q.events.size() == 1);
+    }
+
+    TEST_CASE("T156b: Halted frames block only once input has settled") {
+        gui_idle_t g;
+        // Running: the rest of the frame interval
+        gui_idle_frame(g, 1000);
+        CHECK(gui_idle_timeout(g, false, 1000) == 1000 / GUI_RUN_FPS);
+        CHECK(gui_idle_timeout(g, false, 1000 + 1000 / GUI_RUN_FPS) == 0);
+        CHECK(gui_idle_timeout(g, false, 5000) == 0);
+        // Halted: the running rate until GUI_SETTLE_FRAMES pass without input
+        for (int i = 1; i < GUI_SETTLE_FRAMES; i++) gui_idle_frame(g, 1000);
+        CHECK(gui_idle_timeout(g, true, 1000) == GUI_IDLE_MS);
+        gui_idle_event(g, true);                // a wake doesn't count as input
+        CHECK(gui_idle_timeout(g, true, 1000) == GUI_IDLE_MS);
+        gui_idle_event(g, false);
+        CHECK(gui_idle_timeout(g, true, 1000) == 1000 / GUI_RUN_FPS);
+    }
+}
@@ -0,0 +1,84 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_heat.h"
+#include "emu_rewind.h"
+
+#include <vector>
+
+namespace {
+
+uint64_t sum(const uint32_t *c) {
+    uint64_t s = 0;
+    for (int i = 0; i < (1 << 16); i++) s += c[i];
+    return s;
+}
+
+} // namespace
+
+TEST_SUITE("heat") {
+
+    // -------------------------------------------------------------------------
+    // T150: One count per bus cycle, by kind
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T150: Heatmap counts reads, writes and opcode fetches per address") {
+        std::vector<uint32_t> stepped;
+        for (int fast = 0; fast < 2; fast++) {
+            INFO("fast ", fast);
+            EmulatorFixture f;
+            emulator_enablefast(fast);
+            load_counter(0);
+            CHECK(emu_heat_counts() == nullptr);
+            emulator_run(100, nullptr);
+            while (emulator_getpc() != 0xD002 || !(n8->pins & M6502_SYNC)) emulator_step();
+            emu_heat_enable(true);
+            REQUIRE(emu_heat_enabled());
+            const emu_heat_t *h = emu_heat_counts();
+            emulator_run(19 * 1000, nullptr);
+
+            CHECK(sum(h->r) + sum(h->w) + sum(h->x) == 19 * 1000);
+            const uint16_t ops[] = {0xD002, 0xD003, 0xD006, 0xD007, 0xD00A, 0xD00D};
+            for (uint16_t op : ops) CHECK(h->x[op] == 1000);
+            CHECK(sum(h->x) == 6 * 1000);
+            CHECK(h->w[0x0200] == 1000);
+            CHECK(h->w[0x0201] == 1000);
+            CHECK(sum(h->w) == 2 * 1000);
+            CHECK(h->r[0x0201] == 1000);
+            CHECK(h->r[0xD004] == 1000);        // STX operand
+            CHECK(h->r[0x0200] == 0);
+
+            std::vector<uint32_t> all(h->r, h->r + (1 << 16));
+            all.insert(all.end(), h->w, h->w + (1 << 16));
+            all.insert(all.end(), h->x, h->x + (1 << 16));
+            if (!fast) stepped = all;
+            else CHECK(all == stepped);
+
+            emu_heat_enable(false);
+            CHECK(emu_heat_counts() == nullptr);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // T151: Going back in time doesn't count the replay
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T151: Heatmap ignores cycles re-run by reverse execution") {
+        EmulatorFixture f;
+        load_counter(0);
+        emu_rewind_enable(true);
+        emu_heat_enable(true);
+        for (int i = 0; i < 50; i++) {
+            emulator_run(1000, nullptr);
+            emu_rewind_record();
+        }
+        const emu_heat_t *h = emu_heat_counts();
+        const uint64_t before = sum(h->r) + sum(h->w) + sum(h->x);
+        CHECK(before == emulator_ticks());
+        REQUIRE(emu_rewind_seek(emulator_ticks() - 12345));
+        CHECK(sum(h->r) + sum(h->w) + sum(h->x) == before);
+        emulator_run(1000, nullptr);
+        CHECK(sum(h->r) + sum(h->w) + sum(h->x) == before + 1000);
+        emu_heat_enable(false);
+        emu_rewind_enable(false);
+    }
+}
@@ -5,6 +5,9 @@
 #include "m6502.h"
 #include "emulator.h"
 #include "emu_tty.h"
+#include "emu_sched.h"
+#include "n8_machine.h"
+#include "emu_irq.h"
 #include "emu_labels.h"
 #include "emu_dis6502.h"
 #include "utils.h"
@@ -14,12 +17,6 @@
 #include <string>
 #include <deque>
 
-// ---- Externs for emulator globals not declared in headers ----
-extern m6502_t cpu;
-extern m6502_desc_t desc;
-extern uint64_t pins;
-extern uint64_t tick_count;
-
 // ---- Externs for emu_labels functions not declared in emu_labels.h ----
 extern void emu_labels_add(uint16_t addr, char* label);
 extern void emu_labels_clear();
@@ -55,7 +52,7 @@ inline bool disasm_contains(const char* buf, const char* expected) {
 }
 
 // ---- CpuFixture -- Isolated CPU Testing ----
-// Owns its own m6502_t, mem[], and pins. Zero dependency on emulator globals.
+// Owns its own m6502_t, mem[], and pins. Zero dependency on N8Machine.
 struct CpuFixture {
     m6502_t cpu;
     m6502_desc_t desc;
@@ -142,38 +139,41 @@ struct CpuFixture {
 };
 
 // ---- EmulatorFixture -- Bus Decode & Integration Testing ----
-// Uses the actual emulator globals (mem[], cpu, pins).
+// Uses the default machine (n8->mem[], n8->cpu, n8->pins).
 struct EmulatorFixture {
     EmulatorFixture() {
-        memset(mem, 0, sizeof(uint8_t) * 65536);
-        memset(bp_mask, 0, sizeof(bool) * 65536);
-        memset(wp_write_mask, 0, sizeof(bool) * 65536);
-        memset(wp_read_mask, 0, sizeof(bool) * 65536);
-        memset(&desc, 0, sizeof(desc));
-        tick_count = 0;
+        memset(n8->mem, 0, sizeof(uint8_t) * 65536);
+        emulator_dbg_clear_all(0xFF);
+        memset(&n8->desc, 0, sizeof(n8->desc));
+        n8->tick_count = 0;
         emulator_enablebp(false);
         emulator_enablewp(false);
+        emulator_enablefast(false);
+        emulator_enableidle(true);
         emulator_clear_wp_hit();
         emu_labels_clear();
+        emu_sched_init();
+        emu_irq_reset();
         tty_reset();
-        pins = m6502_init(&cpu, &desc);
+        emulator_bus_init();
+        n8->pins = m6502_init(&n8->cpu, &n8->desc);
         stub_clear_console_buffer();
     }
 
     void load_at(uint16_t addr, const std::vector<uint8_t>& data) {
         for (size_t i = 0; i < data.size(); i++) {
-            mem[addr + i] = data[i];
+            n8->mem[addr + i] = data[i];
         }
     }
 
     void set_reset_vector(uint16_t addr) {
-        mem[0xFFFC] = addr & 0xFF;
-        mem[0xFFFD] = (addr >> 8) & 0xFF;
+        n8->mem[0xFFFC] = addr & 0xFF;
+        n8->mem[0xFFFD] = (addr >> 8) & 0xFF;
     }
 
     void set_irq_vector(uint16_t addr) {
-        mem[0xFFFE] = addr & 0xFF;
-        mem[0xFFFF] = (addr >> 8) & 0xFF;
+        n8->mem[0xFFFE] = addr & 0xFF;
+        n8->mem[0xFFFF] = (addr >> 8) & 0xFF;
     }
 
     void step_n(int n) {
@@ -182,3 +182,16 @@ struct EmulatorFixture {
         }
     }
 };
+
+// ---- Counter program (machine, snapshot, rewind, trace, profiler tests) ----
+// D000: LDX $10; loop: INX; STX $0200; TXA; ADC $0201; STA $0201; JMP loop
+// with $10 = seed, so each seed leaves a different trail.  Only ever writes
+// page $02.  Per pass: INX 2, STX 4, TXA 2, ADC 4, STA 4, JMP 3 = 19 cycles.
+inline void load_counter(uint8_t seed) {
+    const uint8_t prog[] = {0xA6, 0x10, 0xE8, 0x8E, 0x00, 0x02, 0x8A,
+                            0x6D, 0x01, 0x02, 0x8D, 0x01, 0x02, 0x4C, 0x02, 0xD0};
+    for (size_t i = 0; i < sizeof(prog); i++) emulator_write_mem(0xD000 + i, prog[i]);
+    emulator_write_mem(0xFFFC, 0x00);
+    emulator_write_mem(0xFFFD, 0xD0);
+    emulator_write_mem(0x0010, seed);
+}
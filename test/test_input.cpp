@@ -0,0 +1,168 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_input.h"
+#include "emu_rewind.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace {
+
+// D000: loop: LDA $C102; BEQ loop; LDA $C103; STA $0300,X; INX; JMP loop
+void load_tty_logger() {
+    const uint8_t prog[] = {0xAD, 0x02, 0xC1, 0xF0, 0xFB, 0xAD, 0x03, 0xC1,
+                            0x9D, 0x00, 0x03, 0xE8, 0x4C, 0x00, 0xD0};
+    for (size_t i = 0; i < sizeof(prog); i++) emulator_write_mem(0xD000 + i, prog[i]);
+    emulator_write_mem(0xFFFC, 0x00);
+    emulator_write_mem(0xFFFD, 0xD0);
+}
+
+// Host input as the reader thread delivers it
+void host_type(const char *s) {
+    while (*s) n8->tty.rx_ring.push((uint8_t)*s++);
+    n8->tty.rx_pending = true;
+}
+
+void run_chunked(uint64_t cycles, uint64_t chunk) {
+    const uint64_t end = emulator_ticks() + cycles;
+    while (emulator_ticks() < end) {
+        emu_input_run(std::min<uint64_t>(chunk, end - emulator_ticks()), nullptr);
+    }
+}
+
+struct TempLog {
+    char path[32];
+    TempLog() {
+        strcpy(path, "/tmp/n8_input_XXXXXX");
+        int fd = mkstemp(path);
+        if (fd >= 0) close(fd);
+    }
+    ~TempLog() { unlink(path); }
+};
+
+struct Machine {
+    uint64_t ticks;
+    uint16_t pc;
+    uint8_t  a, x, y, s, p;
+    std::vector<uint8_t> mem;
+};
+
+Machine capture() {
+    Machine m = { emulator_ticks(), emulator_getpc(), emulator_read_a(), emulator_read_x(),
+                  emulator_read_y(), emulator_read_s(), emulator_read_p(),
+                  std::vector<uint8_t>(n8->mem, n8->mem + (1 << 16)) };
+    return m;
+}
+
+} // namespace
+
+TEST_SUITE("input") {
+
+    // -------------------------------------------------------------------------
+    // T142: A replayed log repeats the recorded run bit-exactly
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T142: Replay feeds TTY bytes, debugger writes and resets at their cycles") {
+        TempLog log;
+        Machine recorded;
+        {
+            EmulatorFixture f;
+            load_tty_logger();
+            REQUIRE(emu_input_record(log.path));
+            CHECK(emu_input_recording());
+            CHECK_FALSE(emu_input_replay(log.path));     // one log at a time
+            run_chunked(50000, 1000);
+            host_type("hi");
+            run_chunked(100003, 1000);
+            emu_input_apply(EMU_IN_MEM, 0x0300, 'H');
+            emu_input_apply(EMU_IN_REG, 1, 0x40);       // X: log to $0340 on
+            run_chunked(20000, 7000);
+            host_type("yo");
+            run_chunked(100000, 1000);
+            emu_input_apply(EMU_IN_RESET, 0, EMU_IN_RESET_CPU);
+            host_type("!");
+            run_chunked(60000, 1000);
+            CHECK(emu_input_events() == 8);
+            emu_input_stop();
+            CHECK_FALSE(emu_input_recording());
+            recorded = capture();
+            CHECK(memcmp(&n8->mem[0x0300], "Hi", 2) == 0);
+            CHECK(memcmp(&n8->mem[0x0340], "yo!", 3) == 0);
+        }
+
+        for (int fast = 0; fast < 2; fast++) {
+            INFO("fast ", fast);
+            EmulatorFixture f;
+            emulator_enablefast(fast);
+            load_tty_logger();
+            REQUIRE(emu_input_replay(log.path));
+            CHECK(emu_input_replaying());
+            host_type("z");                     // live input waits for the recording's end
+            run_chunked(recorded.ticks, 4096);
+            const Machine replayed = capture();
+            CHECK(replayed.ticks == recorded.ticks);
+            CHECK(replayed.pc == recorded.pc);
+            CHECK(replayed.a == recorded.a);
+            CHECK(replayed.x == recorded.x);
+            CHECK(replayed.y == recorded.y);
+            CHECK(replayed.s == recorded.s);
+            CHECK(replayed.p == recorded.p);
+            CHECK(replayed.mem == recorded.mem);
+            CHECK_FALSE(emu_input_replaying());
+            CHECK(emu_input_events() == 8);
+
+            run_chunked(10000, 1000);
+            CHECK(n8->mem[0x0343] == 'z');
+            emu_input_stop();
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // T143: Logs that don't fit the machine are refused
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T143: Replay checks the start tick and the log format; going back ends a log") {
+        TempLog log;
+        EmulatorFixture f;
+        load_tty_logger();
+        CHECK_FALSE(emu_input_replay("/nonexistent/n8.log"));
+
+        REQUIRE(emu_input_record(log.path));
+        run_chunked(1000, 1000);
+        emu_input_apply(EMU_IN_MEM, 0x0200, 0x55);
+        emu_input_stop();
+
+        // Recorded from tick 0, the machine is past it
+        CHECK_FALSE(emu_input_replay(log.path));
+        CHECK_FALSE(emu_input_replaying());
+
+        // Cut short inside the MEM record
+        FILE *fp = fopen(log.path, "rb");
+        REQUIRE(fp);
+        uint8_t buf[64];
+        const size_t len = fread(buf, 1, sizeof(buf), fp);
+        fclose(fp);
+        CHECK(len == 16 + (2 + 1 + 3) + (1 + 1 + 1));  // header, MEM at 1000, END
+        n8->tick_count = 0;
+        fp = fopen(log.path, "wb");
+        fwrite(buf, 1, 16 + 2 + 1 + 2, fp);
+        fclose(fp);
+        CHECK_FALSE(emu_input_replay(log.path));
+        fp = fopen(log.path, "wb");
+        fwrite("N8IX", 1, 4, fp);
+        fclose(fp);
+        CHECK_FALSE(emu_input_replay(log.path));
+
+        // Rewinding while recording stops the log where the history parts
+        emu_rewind_enable(true);
+        REQUIRE(emu_input_record(log.path));
+        for (int i = 0; i < 20; i++) {
+            run_chunked(1000, 1000);
+            emu_rewind_record();
+        }
+        CHECK(emu_rewind_seek(5000));
+        CHECK_FALSE(emu_input_recording());
+        emu_rewind_enable(false);
+    }
+}
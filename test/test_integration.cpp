@@ -16,7 +16,7 @@ TEST_SUITE("integration") {
         });
         f.set_reset_vector(0xD000);
         f.step_n(20);
-        uint16_t pc = m6502_pc(&cpu);
+        uint16_t pc = m6502_pc(&n8->cpu);
         CHECK(pc >= 0xD000);
         CHECK(pc < 0xD010);
     }
@@ -31,7 +31,7 @@ TEST_SUITE("integration") {
         f.load_at(0xD000, {0xA9, 0x42, 0x8D, 0x00, 0x02, 0xEA});
         f.set_reset_vector(0xD000);
         f.step_n(30);
-        CHECK(mem[0x0200] == 0x42);
+        CHECK(n8->mem[0x0200] == 0x42);
     }
 
     // -------------------------------------------------------------------------
@@ -43,7 +43,7 @@ TEST_SUITE("integration") {
         // LDA #$42; NOP; NOP
         f.load_at(0xD000, {0xA9, 0x42, 0xEA, 0xEA});
         f.set_reset_vector(0xD000);
-        bp_mask[0xD002] = true;
+        emulator_dbg_set(0xD002, DBG_EXEC);
         emulator_enablebp(true);
         f.step_n(30);
         CHECK(emulator_check_break() == true);
@@ -58,7 +58,7 @@ TEST_SUITE("integration") {
         // LDA #$42; NOP; NOP
         f.load_at(0xD000, {0xA9, 0x42, 0xEA, 0xEA});
         f.set_reset_vector(0xD000);
-        bp_mask[0xD002] = true;
+        emulator_dbg_set(0xD002, DBG_EXEC);
         emulator_enablebp(false);
         f.step_n(30);
         CHECK(emulator_check_break() == false);
@@ -76,20 +76,20 @@ TEST_SUITE("integration") {
                             0xEA});
         f.set_reset_vector(0xD000);
         f.step_n(40);
-        CHECK(mem[0xC000] == 0x48);
-        CHECK(mem[0xC001] == 0x69);
+        CHECK(n8->mem[0xC000] == 0x48);
+        CHECK(n8->mem[0xC001] == 0x69);
     }
 
     // -------------------------------------------------------------------------
     // T100: Breakpoint set parsing
     // -------------------------------------------------------------------------
 
-    TEST_CASE("T100: BP set parsing -- emulator_setbp parses '$D000 $D005 $D00A' into bp_mask") {
+    TEST_CASE("T100: BP set parsing -- emulator_setbp parses '$D000 $D005 $D00A' into DBG_EXEC flags") {
         EmulatorFixture f;
         emulator_setbp((char*)"$D000 $D005 $D00A");
-        CHECK(bp_mask[0xD000]);
-        CHECK(bp_mask[0xD005]);
-        CHECK(bp_mask[0xD00A]);
+        CHECK((n8->dbg_flags[0xD000] & DBG_EXEC) != 0);
+        CHECK((n8->dbg_flags[0xD005] & DBG_EXEC) != 0);
+        CHECK((n8->dbg_flags[0xD00A] & DBG_EXEC) != 0);
     }
 
     // -------------------------------------------------------------------------
@@ -100,8 +100,8 @@ TEST_SUITE("integration") {
         EmulatorFixture f;
         emulator_setbp((char*)"$D000");
         emulator_setbp((char*)"$D005");
-        CHECK(bp_mask[0xD000]);
-        CHECK(bp_mask[0xD005]);
+        CHECK((n8->dbg_flags[0xD000] & DBG_EXEC) != 0);
+        CHECK((n8->dbg_flags[0xD005] & DBG_EXEC) != 0);
     }
 
     // -------------------------------------------------------------------------
@@ -143,7 +143,7 @@ TEST_SUITE("integration") {
 
         tty_inject_char('A');
         f.step_n(100);
-        CHECK(m6502_a(&cpu) == 0xFF);
+        CHECK(m6502_a(&n8->cpu) == 0xFF);
     }
 
     // -------------------------------------------------------------------------
@@ -162,7 +162,127 @@ TEST_SUITE("integration") {
 
         tty_inject_char('A');
         f.step_n(50);
-        CHECK(m6502_pc(&cpu) < 0xD100);
+        CHECK(m6502_pc(&n8->cpu) < 0xD100);
     }
 
+    // -------------------------------------------------------------------------
+    // T102: Batched run -- cycle budget
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T102: emulator_run executes exactly max_cycles when nothing stops it") {
+        EmulatorFixture f;
+        f.load_at(0xD000, {0xEA, 0x4C, 0x00, 0xD0});  // NOP; JMP $D000
+        f.set_reset_vector(0xD000);
+        emu_stop_reason_t reason = EMU_STOP_BREAKPOINT;
+        uint64_t ran = emulator_run(1000, &reason);
+        CHECK(ran == 1000);
+        CHECK(n8->tick_count == 1000);
+        CHECK(reason == EMU_STOP_CYCLES);
+    }
+
+    // -------------------------------------------------------------------------
+    // T102a: Batched run -- breakpoint stop
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T102a: emulator_run stops early at an enabled breakpoint") {
+        EmulatorFixture f;
+        f.load_at(0xD000, {0xA9, 0x42, 0xEA, 0xEA});  // LDA #$42; NOP; NOP
+        f.set_reset_vector(0xD000);
+        emulator_dbg_set(0xD002, DBG_EXEC);
+        emulator_enablebp(true);
+        emu_stop_reason_t reason = EMU_STOP_CYCLES;
+        uint64_t ran = emulator_run(1000, &reason);
+        CHECK(reason == EMU_STOP_BREAKPOINT);
+        CHECK(ran < 1000);
+        CHECK(m6502_a(&n8->cpu) == 0x42);
+        CHECK(emulator_check_break() == true);
+    }
+
+    // -------------------------------------------------------------------------
+    // T102b: Batched run -- watchpoint stop
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T102b: emulator_run stops early at a write watchpoint") {
+        EmulatorFixture f;
+        // LDA #$55; STA $0200; JMP $D005
+        f.load_at(0xD000, {0xA9, 0x55, 0x8D, 0x00, 0x02, 0x4C, 0x05, 0xD0});
+        f.set_reset_vector(0xD000);
+        emulator_dbg_set(0x0200, DBG_WRITE);
+        emulator_enablewp(true);
+        emu_stop_reason_t reason = EMU_STOP_CYCLES;
+        emulator_run(1000, &reason);
+        CHECK(reason == EMU_STOP_WATCHPOINT);
+        CHECK(emulator_wp_hit_addr() == 0x0200);
+        emulator_clear_wp_hit();
+    }
+
+    // -------------------------------------------------------------------------
+    // T103: Debug flag page summary
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T103: dbg flags -- clearing the last armed flag on a page disarms it") {
+        EmulatorFixture f;
+        CHECK(emulator_dbg_any(DBG_ARMED) == false);
+        emulator_dbg_set(0x0210, DBG_EXEC);
+        emulator_dbg_set(0x0220, DBG_WRITE);
+        CHECK(emulator_dbg_any(DBG_EXEC) == true);
+        CHECK(emulator_dbg_any(DBG_READ) == false);
+
+        emulator_dbg_clear(0x0210, DBG_EXEC);
+        CHECK(emulator_dbg_any(DBG_EXEC) == false);
+        CHECK(emulator_dbg_any(DBG_WRITE) == true);
+        emulator_dbg_clear(0x0220, DBG_WRITE);
+        CHECK(emulator_dbg_any(DBG_ARMED) == false);
+    }
+
+
+    // -------------------------------------------------------------------------
+    // T104: Idle-loop skipping
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T104: Polling loop on TTY status -- skipped, same state as running it") {
+        EmulatorFixture f;
+        // D000: LDA $C102; BEQ $D000; STA $0200; JMP $D000
+        f.load_at(0xD000, {0xAD, 0x02, 0xC1, 0xF0, 0xFB, 0x8D, 0x00, 0x02, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+        f.step_n(10);
+        emulator_enableidle(false);
+        emulator_run(100000, nullptr);
+        CHECK(emulator_idle() == false);
+        const uint16_t pc = m6502_pc(&n8->cpu);
+        const uint8_t p = m6502_p(&n8->cpu);
+        const uint64_t ticks = n8->tick_count;
+
+        EmulatorFixture g;
+        f.load_at(0xD000, {0xAD, 0x02, 0xC1, 0xF0, 0xFB, 0x8D, 0x00, 0x02, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+        f.step_n(10);
+        CHECK(emulator_run(100000, nullptr) == 100000);
+        CHECK(emulator_idle() == true);
+        CHECK(m6502_pc(&n8->cpu) == pc);
+        CHECK(m6502_p(&n8->cpu) == p);
+        CHECK(n8->tick_count == ticks);
+
+        // Input ends the spin on the next pass
+        tty_inject_char('Z');
+        emulator_run(100, nullptr);
+        CHECK(emulator_idle() == false);
+        CHECK(n8->mem[0x0200] == 0x01);     // In Status: data available
+    }
+
+    TEST_CASE("T104a: Loops that write memory or change registers are not skipped") {
+        EmulatorFixture f;
+        // D000: INC $0200; JMP $D000
+        f.load_at(0xD000, {0xEE, 0x00, 0x02, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+        emulator_run(10000, nullptr);
+        CHECK(emulator_idle() == false);
+
+        EmulatorFixture g;
+        // D000: INX; JMP $D000
+        f.load_at(0xD000, {0xE8, 0x4C, 0x00, 0xD0});
+        f.set_reset_vector(0xD000);
+        emulator_run(10000, nullptr);
+        CHECK(emulator_idle() == false);
+    }
 } // TEST_SUITE("integration")
@@ -0,0 +1,88 @@
+#include "doctest.h"
+#include "test_helpers.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Result {
+    uint64_t ticks;
+    uint8_t  x, out0, out1;
+};
+
+Result run_counter(uint8_t seed, bool fast, uint64_t cycles) {
+    load_counter(seed);
+    emulator_enablefast(fast);
+    emulator_run(cycles, nullptr);
+    Result r = { emulator_ticks(), emulator_read_x(), n8->mem[0x0200], n8->mem[0x0201] };
+    return r;
+}
+
+} // namespace
+
+TEST_SUITE("machine") {
+
+    // -------------------------------------------------------------------------
+    // T132: Machines on separate threads don't see each other
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T132: Parallel machines match a serial run and leave the default machine alone") {
+        EmulatorFixture f;
+        n8->mem[0x0200] = 0xA5;
+        const int count = 8;
+        const uint64_t cycles = 200000;
+
+        std::vector<Result> parallel(count);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < count; i++) {
+            threads.emplace_back([i, &parallel]() {
+                N8Machine *m = n8_machine_new();
+                n8_machine_bind(m);
+                parallel[i] = run_counter((uint8_t)(i * 37), i & 1, cycles);
+                n8_machine_bind(nullptr);
+                n8_machine_free(m);
+            });
+        }
+        for (auto &t : threads) t.join();
+
+        for (int i = 0; i < count; i++) {
+            N8Machine *m = n8_machine_new();
+            N8Machine *prev = n8_machine_bind(m);
+            CHECK(prev == &n8_default);
+            const Result ref = run_counter((uint8_t)(i * 37), false, cycles);
+            n8_machine_bind(prev);
+            n8_machine_free(m);
+
+            INFO("machine ", i);
+            CHECK(parallel[i].ticks == ref.ticks);
+            CHECK(parallel[i].x == ref.x);
+            CHECK(parallel[i].out0 == ref.out0);
+            CHECK(parallel[i].out1 == ref.out1);
+        }
+        CHECK(parallel[0].x != parallel[1].x);
+        CHECK(n8 == &n8_default);
+        CHECK(n8->mem[0x0200] == 0xA5);
+        CHECK(emulator_ticks() == 0);
+    }
+
+    // -------------------------------------------------------------------------
+    // T133: Device state is per machine
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T133: IRQ and TTY input belong to the bound machine") {
+        EmulatorFixture f;
+        N8Machine *m = n8_machine_new();
+        n8_machine_bind(m);
+        tty_inject_char('x');
+        CHECK(tty_buff_count() == 1);
+        CHECK((n8->pins & M6502_IRQ) != 0);
+        CHECK(n8->mem[N8_IRQ_FLAGS] == 0x02);
+        n8_machine_bind(nullptr);
+
+        CHECK(tty_buff_count() == 0);
+        CHECK((n8->pins & M6502_IRQ) == 0);
+        CHECK(emu_irq_flags() == 0);
+        n8_machine_free(m);
+    }
+}
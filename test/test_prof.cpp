@@ -0,0 +1,233 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_prof.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+namespace {
+
+// D000: LDX #$FF; TXS
+// D004: JSR A; JSR B; JSR C; BRK; NOP; JMP $D004
+// A: JSR B; RTS      B: NOP; RTS
+// C: JSR D; NOP; RTS D: PLA; PLA; RTS  (returns straight to C's caller)
+// BRK handler: RTI
+// Per pass: loop 3*6 + 7 + 3, A 6+6, B 2+6 (twice), C 6, D 4+4+6, RTI 6 = 82
+void load_calls() {
+    const uint8_t prog[] = {0xA2, 0xFF, 0x9A, 0xEA,
+                            0x20, 0x20, 0xD0, 0x20, 0x30, 0xD0, 0x20, 0x40, 0xD0,
+                            0x00, 0xEA, 0x4C, 0x04, 0xD0};
+    for (size_t i = 0; i < sizeof(prog); i++) emulator_write_mem(0xD000 + i, prog[i]);
+    const uint8_t a[] = {0x20, 0x30, 0xD0, 0x60}, b[] = {0xEA, 0x60};
+    const uint8_t c[] = {0x20, 0x50, 0xD0, 0xEA, 0x60}, d[] = {0x68, 0x68, 0x60};
+    for (size_t i = 0; i < sizeof(a); i++) emulator_write_mem(0xD020 + i, a[i]);
+    for (size_t i = 0; i < sizeof(b); i++) emulator_write_mem(0xD030 + i, b[i]);
+    for (size_t i = 0; i < sizeof(c); i++) emulator_write_mem(0xD040 + i, c[i]);
+    for (size_t i = 0; i < sizeof(d); i++) emulator_write_mem(0xD050 + i, d[i]);
+    emulator_write_mem(0xD060, 0x40);
+    emulator_write_mem(0xFFFC, 0x00);
+    emulator_write_mem(0xFFFD, 0xD0);
+    emulator_write_mem(0xFFFE, 0x60);
+    emulator_write_mem(0xFFFF, 0xD0);
+}
+
+const emu_prof_edge_t *find_edge(const emu_prof_graph_t &g, uint16_t caller, uint16_t callee) {
+    for (const emu_prof_edge_t &e : g.edges) {
+        if (e.caller == caller && e.callee == callee) return &e;
+    }
+    return nullptr;
+}
+
+uint64_t self_of(const emu_prof_graph_t &g, uint16_t fn) {
+    for (const auto &f : g.self) {
+        if (f.first == fn) return f.second;
+    }
+    return 0;
+}
+
+} // namespace
+
+TEST_SUITE("prof") {
+
+    // -------------------------------------------------------------------------
+    // T146: Cycles are charged to the instruction that spent them
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T146: Profile counts each instruction's cycles at its address") {
+        for (int fast = 0; fast < 2; fast++) {
+            INFO("fast ", fast);
+            EmulatorFixture f;
+            emulator_enablefast(fast);
+            load_counter(0);
+            CHECK(emu_prof_cycles() == nullptr);
+            emulator_run(100, nullptr);         // reset sequence and first passes
+            emu_prof_enable(true);
+            CHECK(emu_prof_enabled());
+            const uint32_t *c = emu_prof_cycles();
+            REQUIRE(c);
+
+            // Stop just after the loop head's opcode fetch and run 1000 passes,
+            // up to and including the next fetch there.  Clearing mid-instruction
+            // starts its count from the clear, so the first INX is a cycle short.
+            while (emulator_getpc() != 0xD002 || !(n8->pins & M6502_SYNC)) emulator_step();
+            emu_prof_clear();
+            emulator_run(19 * 1000, nullptr);
+            CHECK(c[0xD002] == 2 * 1000 - 1);
+            CHECK(c[0xD003] == 4 * 1000);
+            CHECK(c[0xD006] == 2 * 1000);
+            CHECK(c[0xD007] == 4 * 1000);
+            CHECK(c[0xD00A] == 4 * 1000);
+            CHECK(c[0xD00D] == 3 * 1000);
+            uint64_t total = 0;
+            for (int i = 0; i < 65536; i++) total += c[i];
+            CHECK(total == 19 * 1000 - 1);
+            emu_prof_enable(false);
+            CHECK(emu_prof_cycles() == nullptr);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // T147: Per-symbol totals use the nearest label at or below
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T147: Symbol totals and the saved table") {
+        EmulatorFixture f;
+        std::vector<uint32_t> cycles(1 << 16, 0);
+        cycles[0x0100] = 5;         // before any label
+        cycles[0xD000] = 10;
+        cycles[0xD004] = 20;
+        cycles[0xD010] = 300;
+        cycles[0xD013] = 1;
+        emu_labels_add(0xD000, (char *)"main");
+        emu_labels_add(0xD010, (char *)"putc");
+        emu_labels_add(0xE000, (char *)"unused");
+
+        std::vector<emu_prof_sym_t> syms;
+        emu_prof_symbols(cycles.data(), syms);
+        REQUIRE(syms.size() == 3);
+        CHECK(syms[0].name == "putc");
+        CHECK(syms[0].cycles == 301);
+        CHECK(syms[1].name == "main");
+        CHECK(syms[1].addr == 0xD000);
+        CHECK(syms[1].cycles == 30);
+        CHECK(syms[2].name == "$0000");
+        CHECK(syms[2].cycles == 5);
+
+        char path[] = "/tmp/n8_prof_XXXXXX";
+        const int fd = mkstemp(path);
+        REQUIRE(fd >= 0);
+        close(fd);
+        REQUIRE(emu_prof_save(path, cycles.data()));
+        FILE *fp = fopen(path, "r");
+        REQUIRE(fp);
+        char text[1024] {0};
+        fread(text, 1, sizeof(text) - 1, fp);
+        fclose(fp);
+        unlink(path);
+        CHECK(strstr(text, "# 336 cycles") != nullptr);
+        CHECK(strstr(text, "301  89.58%  $D010  putc") != nullptr);
+        emu_labels_clear();
+    }
+
+    // -------------------------------------------------------------------------
+    // T148: Call graph from the shadow call stack
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T148: Call edges get inclusive cycles, functions exclusive ones") {
+        for (int fast = 0; fast < 2; fast++) {
+            INFO("fast ", fast);
+            EmulatorFixture f;
+            emulator_enablefast(fast);
+            load_calls();
+            emu_prof_graph_t g;
+            CHECK_FALSE(emu_prof_graph(g));
+
+            // As in T146, the first JSR at the bottom is a cycle short
+            while (emulator_getpc() != 0xD004 || !(n8->pins & M6502_SYNC)) emulator_step();
+            emu_prof_enable(true);
+            emulator_run(82 * 100, nullptr);
+            REQUIRE(emu_prof_graph(g));
+            CHECK(g.total == 82 * 100 - 1);
+            CHECK(self_of(g, 0xD004) == 28 * 100 - 1);
+            CHECK(self_of(g, 0xD020) == 12 * 100);
+            CHECK(self_of(g, 0xD030) == 16 * 100);
+            CHECK(self_of(g, 0xD040) == 6 * 100);
+            CHECK(self_of(g, 0xD050) == 14 * 100);
+            CHECK(self_of(g, 0xD060) == 6 * 100);
+
+            struct { uint16_t caller, site, callee; uint64_t incl; } want[] = {
+                {0xD004, 0xD004, 0xD020, 20}, {0xD020, 0xD020, 0xD030, 8},
+                {0xD004, 0xD007, 0xD030, 8},  {0xD004, 0xD00A, 0xD040, 20},
+                {0xD040, 0xD040, 0xD050, 14}, {0xD004, 0xD00D, 0xD060, 6},
+            };
+            CHECK(g.edges.size() == 6);
+            for (const auto &w : want) {
+                INFO("callee ", w.callee);
+                const emu_prof_edge_t *e = find_edge(g, w.caller, w.callee);
+                REQUIRE(e);
+                CHECK(e->site == w.site);
+                CHECK(e->calls == 100);
+                CHECK(e->incl == w.incl * 100);
+            }
+
+            // Stopped on B's first fetch, called from A: calls in flight
+            // count as returned at the last fetch
+            emulator_run(6 + 6, nullptr);
+            REQUIRE(emu_prof_graph(g));
+            CHECK(find_edge(g, 0xD004, 0xD020)->calls == 101);
+            CHECK(find_edge(g, 0xD004, 0xD020)->incl == 20 * 100 + 6);
+            CHECK(find_edge(g, 0xD020, 0xD030)->calls == 101);
+            CHECK(find_edge(g, 0xD020, 0xD030)->incl == 8 * 100);
+
+            // A reset unwinds to the bottom, which is now the reset handler
+            n8->pins |= M6502_RES;
+            emulator_run(100, nullptr);
+            REQUIRE(emu_prof_graph(g));
+            CHECK(find_edge(g, 0xD004, 0xD020)->calls == 101);
+            REQUIRE(find_edge(g, 0xD000, 0xD020));
+            CHECK(find_edge(g, 0xD000, 0xD020)->calls == 1);
+            emu_prof_clear();
+            emulator_run(82 * 10, nullptr);
+            REQUIRE(emu_prof_graph(g));
+            CHECK(self_of(g, 0xD004) == 0);
+            CHECK(self_of(g, 0xD000) > 0);
+            CHECK(find_edge(g, 0xD004, 0xD020) == nullptr);
+            CHECK(find_edge(g, 0xD000, 0xD020)->calls >= 9);     // ten passes, out of phase
+            emu_prof_enable(false);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // T149: callgrind export
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T149: Callgrind file names functions once and lists call sites") {
+        EmulatorFixture f;
+        emu_labels_add(0xD000, (char *)"main");
+        emu_labels_add(0xD010, (char *)"putc");
+        emu_prof_graph_t g;
+        g.self = {{0xD000, 30}, {0xD010, 301}, {0xD014, 5}};
+        g.edges = {{0xD000, 0xD003, 0xD010, 2, 306}, {0xD014, 0xD016, 0xD010, 1, 0}};
+        g.total = 336;
+
+        char path[] = "/tmp/n8_cg_XXXXXX";
+        const int fd = mkstemp(path);
+        REQUIRE(fd >= 0);
+        close(fd);
+        REQUIRE(emu_prof_callgrind(path, g));
+        FILE *fp = fopen(path, "r");
+        REQUIRE(fp);
+        char text[1024] {0};
+        fread(text, 1, sizeof(text) - 1, fp);
+        fclose(fp);
+        unlink(path);
+        CHECK(std::string(text) ==
+              "# callgrind format\nversion: 1\ncreator: n8machine\npositions: instr\n"
+              "events: Cycles\nsummary: 336\n"
+              "\nfn=(1) main\n0xD000 30\ncfn=(2) putc\ncalls=2 0xD010\n0xD003 306\n"
+              "\nfn=(2)\n0xD010 301\n"
+              "\nfn=(3) putc+4\n0xD014 5\ncfn=(2)\ncalls=1 0xD010\n0xD016 0\n");
+        emu_labels_clear();
+    }
+
+}
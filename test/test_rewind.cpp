@@ -0,0 +1,182 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_rewind.h"
+
+namespace {
+
+// D000: loop: LDA $C102; BEQ loop; LDA $C103; STA $0300,X; INX; JMP loop
+void load_tty_logger() {
+    const uint8_t prog[] = {0xAD, 0x02, 0xC1, 0xF0, 0xFB, 0xAD, 0x03, 0xC1,
+                            0x9D, 0x00, 0x03, 0xE8, 0x4C, 0x00, 0xD0};
+    for (size_t i = 0; i < sizeof(prog); i++) emulator_write_mem(0xD000 + i, prog[i]);
+    emulator_write_mem(0xFFFC, 0x00);
+    emulator_write_mem(0xFFFD, 0xD0);
+}
+
+// As the emulation thread does: checkpoint between batches
+uint64_t run_recorded(uint64_t cycles) {
+    const uint64_t end = emulator_ticks() + cycles;
+    emu_stop_reason_t reason = EMU_STOP_CYCLES;
+    while (emulator_ticks() < end && reason == EMU_STOP_CYCLES) {
+        emulator_run(std::min<uint64_t>(1000, end - emulator_ticks()), &reason);
+        emu_rewind_record();
+    }
+    return emulator_ticks();
+}
+
+// One instruction, the way the GDB stub steps
+void step_instruction() {
+    do { emulator_step(); } while (!(n8->pins & M6502_SYNC));
+}
+
+// Host input as the reader thread delivers it
+void host_type(const char *s) {
+    while (*s) n8->tty.rx_ring.push((uint8_t)*s++);
+    n8->tty.rx_pending = true;
+}
+
+struct Probe {
+    uint64_t ticks;
+    uint16_t pc;
+    uint8_t  a, x, p, out0, out1;
+    bool operator==(const Probe &o) const {
+        return ticks == o.ticks && pc == o.pc && a == o.a && x == o.x && p == o.p &&
+               out0 == o.out0 && out1 == o.out1;
+    }
+};
+
+Probe probe() {
+    Probe p = { emulator_ticks(), emulator_getpc(), emulator_read_a(), emulator_read_x(),
+                emulator_read_p(), n8->mem[0x0200], n8->mem[0x0201] };
+    return p;
+}
+
+} // namespace
+
+TEST_SUITE("rewind") {
+
+    // -------------------------------------------------------------------------
+    // T139: Reverse step retraces recorded instructions
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T139: Reverse step walks back one instruction at a time") {
+        EmulatorFixture f;
+        load_counter(3);
+        emu_rewind_enable(true);
+        CHECK(emu_rewind_step() == EMU_REWIND_BEGIN);     // nothing recorded yet
+
+        run_recorded(250000);
+        step_instruction();
+        std::vector<Probe> trail;
+        for (int i = 0; i < 40; i++) {
+            trail.push_back(probe());
+            step_instruction();
+            emu_rewind_record();
+        }
+        for (int i = 39; i >= 0; i--) {
+            INFO("instruction ", i);
+            CHECK(emu_rewind_step() == EMU_REWIND_STOPPED);
+            CHECK(probe() == trail[i]);
+        }
+        CHECK(emu_rewind_interval() >= 10000);
+
+        // Forward again re-runs the same history; seeking lands anywhere in it
+        const uint64_t last = emu_rewind_last();
+        CHECK(emu_rewind_seek(1234));
+        CHECK(emulator_ticks() == 1234);
+        CHECK(emu_rewind_seek(trail[20].ticks));
+        CHECK(probe() == trail[20]);
+        CHECK(emu_rewind_seek(last + 1000));
+        CHECK(emulator_ticks() == last);
+        emu_rewind_enable(false);
+        CHECK_FALSE(emu_rewind_enabled());
+        CHECK(emu_rewind_step() == EMU_REWIND_OFF);
+    }
+
+    // -------------------------------------------------------------------------
+    // T140: Reverse continue stops at the previous breakpoint / watchpoint hit
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T140: Reverse continue finds the last breakpoint and watchpoint hit") {
+        EmulatorFixture f;
+        load_counter(9);
+        emu_rewind_enable(true);
+        const uint64_t now = run_recorded(250003);
+
+        emulator_dbg_set(0xD00D, DBG_EXEC);     // JMP loop
+        emulator_enablebp(true);
+        emu_stop_reason_t reason;
+        REQUIRE(emu_rewind_continue(&reason) == EMU_REWIND_STOPPED);
+        CHECK(reason == EMU_STOP_BREAKPOINT);
+        CHECK(emulator_bp_hit());
+        const uint64_t t1 = emulator_ticks();
+        CHECK(t1 < now);
+        CHECK(t1 + 19 >= now);
+        emulator_clear_bp_hit();
+
+        REQUIRE(emu_rewind_continue(&reason) == EMU_REWIND_STOPPED);
+        CHECK(t1 - emulator_ticks() == 19);
+        emulator_clear_bp_hit();
+        emulator_dbg_clear(0xD00D, DBG_EXEC);
+        emulator_enablebp(false);
+
+        // Watchpoint: the STA $0201 of the pass before
+        emulator_dbg_set(0x0201, DBG_WRITE);
+        emulator_enablewp(true);
+        REQUIRE(emu_rewind_continue(&reason) == EMU_REWIND_STOPPED);
+        CHECK(reason == EMU_STOP_WATCHPOINT);
+        CHECK(emulator_wp_hit_addr() == 0x0201);
+        CHECK(emulator_wp_hit_type() == 2);
+        emulator_clear_wp_hit();
+        emulator_dbg_clear(0x0201, DBG_WRITE);
+        emulator_enablewp(false);
+
+        // No hits left: back to the oldest state
+        CHECK(emu_rewind_continue(&reason) == EMU_REWIND_BEGIN);
+        CHECK(emulator_ticks() == emu_rewind_first());
+        emu_rewind_enable(false);
+    }
+
+    // -------------------------------------------------------------------------
+    // T141: Host input is replayed at the same cycles after going back
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T141: Replayed TTY input matches the original run, live input waits") {
+        EmulatorFixture f;
+        load_tty_logger();
+        emu_rewind_enable(true);
+        run_recorded(50000);
+        host_type("hi");
+        run_recorded(100000);
+        host_type("yo");
+        const uint64_t end = run_recorded(100000);
+        const uint8_t x = emulator_read_x();
+        CHECK(x == 4);
+        CHECK(memcmp(&n8->mem[0x0300], "hiyo", 4) == 0);
+
+        // Back to before any input, then forward again with new input queued
+        CHECK(emu_rewind_seek(10000));
+        CHECK(n8->mem[0x0300] == 0);
+        CHECK(emulator_read_x() == 0);
+        host_type("z");
+        CHECK(emu_rewind_seek(end));
+        CHECK(emulator_read_x() == x);
+        CHECK(memcmp(&n8->mem[0x0300], "hiyo", 4) == 0);
+        CHECK(n8->mem[0x0304] == 0);            // held back during the replay
+
+        run_recorded(10000);
+        CHECK(n8->mem[0x0304] == 'z');
+
+        // A debugger edit cuts the history: no future to seek into
+        emulator_write_mem(0x0300, 'H');
+        emu_rewind_mark();
+        CHECK(emu_rewind_last() == emulator_ticks());
+        const uint64_t edited = emulator_ticks();
+        CHECK(emu_rewind_seek(20000));
+        CHECK(n8->mem[0x0300] == 0);
+        CHECK(emu_rewind_seek(edited + 500000));
+        CHECK(emulator_ticks() == edited);
+        CHECK(n8->mem[0x0300] == 'H');
+        emu_rewind_enable(false);
+    }
+}
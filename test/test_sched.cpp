@@ -0,0 +1,94 @@
+#include "doctest.h"
+#include "test_helpers.h"
+
+#include <vector>
+
+namespace {
+
+std::vector<uint64_t> fired;
+void record(uint64_t now) { fired.push_back(now); }
+
+uint64_t period_next;
+void periodic(uint64_t now) {
+    fired.push_back(now);
+    emu_sched_at(EMU_EV_TTY_RX, now + period_next, periodic);
+}
+
+// Device event in the middle of an idle spin: input arrives
+uint64_t event_tick;
+void input_arrives(uint64_t now) {
+    event_tick = now;
+    tty_inject_char('k');
+}
+
+} // namespace
+
+TEST_SUITE("sched") {
+
+    // -------------------------------------------------------------------------
+    // T130: Deadlines
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T130: emu_sched -- booking, moving and cancelling update the next deadline") {
+        emu_sched_init();
+        fired.clear();
+        CHECK(n8->sched.due == EMU_SCHED_NEVER);
+
+        emu_sched_at(EMU_EV_TTY_RX, 500, record);
+        CHECK(emu_sched_booked(EMU_EV_TTY_RX));
+        CHECK(n8->sched.due == 500);
+        emu_sched_at(EMU_EV_TTY_RX, 200, record);   // move earlier
+        CHECK(n8->sched.due == 200);
+        emu_sched_at(EMU_EV_TTY_RX, 900, record);   // move later
+        CHECK(n8->sched.due == 900);
+
+        emu_sched_poll(899);
+        CHECK(fired.empty());
+        emu_sched_poll(905);
+        REQUIRE(fired.size() == 1);
+        CHECK(fired[0] == 905);
+        CHECK(emu_sched_booked(EMU_EV_TTY_RX) == false);
+        CHECK(n8->sched.due == EMU_SCHED_NEVER);
+
+        emu_sched_at(EMU_EV_TTY_RX, 100, record);
+        emu_sched_cancel(EMU_EV_TTY_RX);
+        CHECK(n8->sched.due == EMU_SCHED_NEVER);
+        emu_sched_run(1000);
+        CHECK(fired.size() == 1);
+    }
+
+    TEST_CASE("T130a: emu_sched -- a handler can book itself again") {
+        emu_sched_init();
+        fired.clear();
+        period_next = 87;
+        emu_sched_at(EMU_EV_TTY_RX, 87, periodic);
+        for (uint64_t t = 0; t <= 87 * 4; t++) emu_sched_poll(t);
+        REQUIRE(fired.size() == 4);
+        CHECK(fired[3] == 87 * 4);
+        CHECK(n8->sched.due == 87 * 5);
+        emu_sched_init();
+    }
+
+    // -------------------------------------------------------------------------
+    // T131: Batched execution stops at device events
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T131: Idle skip and fast mode both stop at the next device event") {
+        for (int fast = 0; fast < 2; fast++) {
+            EmulatorFixture f;
+            // D000: LDA $C102; BEQ $D000; STA $0200; JMP $D000
+            f.load_at(0xD000, {0xAD, 0x02, 0xC1, 0xF0, 0xFB, 0x8D, 0x00, 0x02, 0x4C, 0x00, 0xD0});
+            f.set_reset_vector(0xD000);
+            f.step_n(10);
+            emulator_enablefast(fast != 0);
+            event_tick = 0;
+            emu_sched_at(EMU_EV_TTY_RX, 50000, input_arrives);
+
+            emulator_run(100000, nullptr);
+            CHECK(event_tick == 50000);
+            CHECK(n8->mem[0x0200] == 0x01);
+            CHECK(n8->tick_count == 100010);
+            emulator_enablefast(false);
+        }
+    }
+}
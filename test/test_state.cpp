@@ -0,0 +1,123 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_state.h"
+
+namespace {
+
+struct Probe {
+    uint64_t ticks;
+    uint16_t pc;
+    uint8_t  x, out0, out1;
+    bool operator==(const Probe &o) const {
+        return ticks == o.ticks && pc == o.pc && x == o.x && out0 == o.out0 && out1 == o.out1;
+    }
+};
+
+Probe probe() {
+    Probe p = { emulator_ticks(), emulator_getpc(), emulator_read_x(), n8->mem[0x0200], n8->mem[0x0201] };
+    return p;
+}
+
+} // namespace
+
+TEST_SUITE("state") {
+
+    // -------------------------------------------------------------------------
+    // T135: Restore puts the machine back exactly
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T135: Running on from a restored state repeats the original run") {
+        EmulatorFixture f;
+        load_counter(7);
+        emulator_run(1003, nullptr);
+
+        emu_state_store_t *st = emu_state_new();
+        const int id = emu_state_save(st);
+        const Probe at_save = probe();
+        emulator_run(5000, nullptr);
+        const Probe first = probe();
+
+        for (int fast = 0; fast < 2; fast++) {
+            INFO("fast ", fast);
+            emulator_enablefast(fast);
+            CHECK(emu_state_restore(st, id));
+            CHECK(probe() == at_save);
+            emulator_run(5000, nullptr);
+            CHECK(probe() == first);
+        }
+        CHECK_FALSE(emu_state_restore(st, id + 1));
+        emu_state_free(st);
+    }
+
+    // -------------------------------------------------------------------------
+    // T136: Snapshots store only pages written since the previous one
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T136: Delta snapshots share unchanged pages and branch correctly") {
+        EmulatorFixture f;
+        load_counter(1);
+        emulator_run(100, nullptr);
+
+        emu_state_store_t *st = emu_state_new();
+        const int s0 = emu_state_save(st);
+        CHECK(emu_state_pages(st) == 256);
+
+        emulator_run(2000, nullptr);
+        const int s1 = emu_state_save(st);
+        const Probe p1 = probe();
+        CHECK(emu_state_pages(st) == 257);      // page $02 only
+
+        // Branch off s0 with a different seed: pages $00 and $02 change
+        CHECK(emu_state_restore(st, s0));
+        emulator_write_mem(0x0010, 0x55);
+        emulator_write_mem(0x0050, 0xAA);
+        emulator_run(2000, nullptr);
+        const int s2 = emu_state_save(st);
+        CHECK(emu_state_pages(st) == 259);
+        CHECK(emu_state_count(st) == 3);
+
+        CHECK(emu_state_restore(st, s1));
+        CHECK(probe() == p1);
+        CHECK(n8->mem[0x0010] == 1);
+        CHECK(n8->mem[0x0050] == 0);
+
+        CHECK(emu_state_restore(st, s2));
+        CHECK(n8->mem[0x0050] == 0xAA);
+
+        // Dropping s2 frees its pages; restores still work without a base
+        emu_state_truncate(st, 2);
+        CHECK(emu_state_count(st) == 2);
+        CHECK(emu_state_pages(st) == 257);
+        CHECK(emu_state_restore(st, s1));
+        CHECK(probe() == p1);
+        CHECK(n8->mem[0x0050] == 0);
+        emu_state_free(st);
+    }
+
+    // -------------------------------------------------------------------------
+    // T137: TTY input FIFO and IRQ state are part of a snapshot
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T137: Restore brings back queued TTY input and the IRQ line") {
+        EmulatorFixture f;
+        load_counter(0);
+        emu_state_store_t *st = emu_state_new();
+        const int empty = emu_state_save(st);
+        tty_inject_char('a');
+        tty_inject_char('b');
+        const int queued = emu_state_save(st);
+
+        CHECK(emu_state_restore(st, empty));
+        CHECK(tty_buff_count() == 0);
+        CHECK(emu_irq_flags() == 0);
+        CHECK((n8->pins & M6502_IRQ) == 0);
+        CHECK(n8->mem[N8_IRQ_FLAGS] == 0);
+
+        CHECK(emu_state_restore(st, queued));
+        CHECK(tty_buff_count() == 2);
+        CHECK(emu_irq_flags() == 0x02);
+        CHECK((n8->pins & M6502_IRQ) != 0);
+        CHECK(n8->mem[N8_IRQ_FLAGS] == 0x02);
+        emu_state_free(st);
+    }
+}
@@ -0,0 +1,116 @@
+#include "doctest.h"
+#include "test_helpers.h"
+#include "emu_trace.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+namespace {
+
+// What the trace should hold: the state at every opcode fetch
+std::vector<emu_trace_entry_t> reference(uint64_t cycles) {
+    std::vector<emu_trace_entry_t> ref;
+    while (emulator_ticks() < cycles) {
+        emulator_step();
+        if (n8->pins & M6502_SYNC) {
+            const uint16_t pc = M6502_GET_ADDR(n8->pins);
+            emu_trace_entry_t e = { emulator_ticks() - 1, pc, emulator_read_a(), emulator_read_x(),
+                                    emulator_read_y(), emulator_read_s(), n8->cpu.P, n8->mem[pc] };
+            ref.push_back(e);
+        }
+    }
+    return ref;
+}
+
+bool same(const emu_trace_entry_t &a, const emu_trace_entry_t &b) {
+    return a.tick == b.tick && a.pc == b.pc && a.a == b.a && a.x == b.x && a.y == b.y &&
+           a.s == b.s && a.p == b.p && a.op == b.op;
+}
+
+} // namespace
+
+TEST_SUITE("trace") {
+
+    // -------------------------------------------------------------------------
+    // T144: The ring holds the newest instructions, oldest first
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T144: Trace entries match the state at each opcode fetch") {
+        std::vector<emu_trace_entry_t> ref;
+        {
+            EmulatorFixture f;
+            load_counter(5);
+            ref = reference(5000);
+        }
+        REQUIRE(ref.size() > 300);
+
+        for (int fast = 0; fast < 2; fast++) {
+            INFO("fast ", fast);
+            EmulatorFixture f;
+            emulator_enablefast(fast);
+            load_counter(5);
+            emu_trace_enable(200);
+            CHECK(emu_trace_capacity() == 256);
+            emulator_run(5000, nullptr);
+            REQUIRE(emu_trace_count() == 256);
+
+            std::vector<emu_trace_entry_t> got;
+            emu_trace_copy(got);
+            const size_t skip = ref.size() - 256;
+            for (size_t i = 0; i < got.size(); i++) {
+                INFO("entry ", i);
+                CHECK(same(got[i], ref[skip + i]));
+            }
+            emu_trace_entry_t e;
+            CHECK(emu_trace_get(255, e));
+            CHECK(same(e, ref.back()));
+            CHECK_FALSE(emu_trace_get(256, e));
+
+            emu_trace_clear();
+            CHECK(emu_trace_count() == 0);
+            emu_trace_enable(0);
+            CHECK(emu_trace_capacity() == 0);
+            CHECK(emu_trace_count() == 0);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // T145: Binary dump
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T145: Trace dump writes a header and one column per field") {
+        EmulatorFixture f;
+        load_counter(1);
+        emu_trace_enable(16);
+        emulator_run(300, nullptr);
+        std::vector<emu_trace_entry_t> got;
+        emu_trace_copy(got);
+        REQUIRE(got.size() == 16);
+
+        char path[] = "/tmp/n8_trace_XXXXXX";
+        const int fd = mkstemp(path);
+        REQUIRE(fd >= 0);
+        close(fd);
+        REQUIRE(emu_trace_save(path, got));
+        FILE *fp = fopen(path, "rb");
+        REQUIRE(fp);
+        uint8_t buf[512];
+        const size_t len = fread(buf, 1, sizeof(buf), fp);
+        fclose(fp);
+        unlink(path);
+
+        CHECK(len == 16 + 16 * (8 + 2 + 6));
+        CHECK(memcmp(buf, "N8TR", 4) == 0);
+        CHECK(buf[4] == EMU_TRACE_VERSION);
+        CHECK(buf[8] == 16);
+        const uint8_t *tick = buf + 16, *pc = tick + 16 * 8, *op = pc + 16 * 2 + 16 * 5;
+        for (int i = 0; i < 16; i++) {
+            uint64_t t = 0;
+            for (int b = 0; b < 8; b++) t |= (uint64_t)tick[i * 8 + b] << (8 * b);
+            CHECK(t == got[i].tick);
+            CHECK((pc[i * 2] | (pc[i * 2 + 1] << 8)) == got[i].pc);
+            CHECK(op[i] == got[i].op);
+        }
+        emu_trace_enable(0);
+    }
+}
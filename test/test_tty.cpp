@@ -1,6 +1,10 @@
 #include "doctest.h"
 #include "test_helpers.h"
 
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+
 TEST_SUITE("tty") {
 
     // -------------------------------------------------------------------------
@@ -9,7 +13,7 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T71: Read Out Status (reg 0) returns 0x00") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         uint64_t p = make_read_pins(0xC100);
         tty_decode(p, 0);
         CHECK(M6502_GET_DATA(p) == 0x00);
@@ -21,7 +25,7 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T72: Read Out Data (reg 1) returns 0xFF") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         uint64_t p = make_read_pins(0xC101);
         tty_decode(p, 1);
         CHECK(M6502_GET_DATA(p) == 0xFF);
@@ -33,7 +37,7 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T73: Read In Status empty (reg 2) returns 0x00") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         uint64_t p = make_read_pins(0xC102);
         tty_decode(p, 2);
         CHECK(M6502_GET_DATA(p) == 0x00);
@@ -45,7 +49,7 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T74: Read In Status with data (reg 2) returns 0x01") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         tty_inject_char('A');
         uint64_t p = make_read_pins(0xC102);
         tty_decode(p, 2);
@@ -58,7 +62,7 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T75: Read In Data (reg 3) returns injected char and drains buffer") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         tty_inject_char(0x41);
         uint64_t p = make_read_pins(0xC103);
         tty_decode(p, 3);
@@ -72,12 +76,12 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T76: Read In Data (reg 3) clears IRQ bit 1 after buffer drains") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         tty_inject_char('X');
         emu_set_irq(1);
         uint64_t p = make_read_pins(0xC103);
         tty_decode(p, 3);
-        CHECK((mem[0x00FF] & 0x02) == 0);
+        CHECK((emu_irq_flags() & 0x02) == 0);
     }
 
     // -------------------------------------------------------------------------
@@ -86,7 +90,7 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T77: Write Out Data (reg 1) does not crash") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         uint64_t write_p = make_write_pins(0xC101, 'H');
         tty_decode(write_p, 1);
         // putchar side effect is acceptable; just verify no crash
@@ -99,7 +103,7 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T78: Write to read-only regs 0, 2, 3 does not crash") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         uint64_t p0 = make_write_pins(0xC100, 0xAA);
         tty_decode(p0, 0);
         uint64_t p2 = make_write_pins(0xC102, 0xBB);
@@ -115,7 +119,7 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T78a: Read TTY phantom addresses (regs 4-15) return 0x00") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         for (uint8_t reg = 4; reg <= 15; reg++) {
             uint64_t p = make_read_pins(0xC100 + reg);
             tty_decode(p, reg);
@@ -129,11 +133,115 @@ TEST_SUITE("tty") {
 
     TEST_CASE("T79: tty_reset clears buffer after injecting chars") {
         tty_reset();
-        mem[0x00FF] = 0;
+        emu_irq_reset();
         tty_inject_char('A');
         tty_inject_char('B');
         tty_reset();
         CHECK(tty_buff_count() == 0);
     }
 
+    // -------------------------------------------------------------------------
+    // T79a: Background reader feeds the FIFO at UART byte time
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T79a: Host input via reader thread -- bytes arrive in order, IRQ raised") {
+        emu_sched_init();
+        tty_reset();
+        emu_irq_reset();
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        tty_start_reader(fds[0]);
+        REQUIRE(write(fds[1], "hi", 2) == 2);
+        close(fds[1]);   // EOF ends the reader
+
+        uint64_t now = 0;
+        for (int i = 0; i < 2000 && tty_buff_count() < 2; i++) {
+            tty_poll(now);
+            now += 100;
+            emu_sched_poll(now);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(tty_buff_count() == 2);
+        CHECK((emu_irq_flags() & 0x02) != 0);
+
+        uint64_t r = make_read_pins(0xC103);
+        tty_decode(r, 3);
+        CHECK(M6502_GET_DATA(r) == 'h');
+        r = make_read_pins(0xC103);
+        tty_decode(r, 3);
+        CHECK(M6502_GET_DATA(r) == 'i');
+        tty_stop_reader();
+        close(fds[0]);
+        tty_reset();
+    }
+
+    // -------------------------------------------------------------------------
+    // T79b: Waiting for host input
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T79b: tty_wait_input -- times out when idle, wakes on input") {
+        tty_reset();
+        emu_irq_reset();
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        tty_start_reader(fds[0]);
+        CHECK(tty_wait_input(20) == false);
+
+        std::thread writer([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            CHECK(write(fds[1], "x", 1) == 1);
+        });
+        auto t0 = std::chrono::steady_clock::now();
+        CHECK(tty_wait_input(5000) == true);
+        CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(4000));
+        writer.join();
+
+        emu_sched_init();
+        tty_poll(0);
+        emu_sched_run(1000);
+        CHECK(tty_buff_count() == 1);
+
+        tty_stop_reader();
+        close(fds[1]);
+        close(fds[0]);
+        tty_reset();
+    }
+
+    // -------------------------------------------------------------------------
+    // T79c: Freeing a machine stops its reader
+    // -------------------------------------------------------------------------
+
+    TEST_CASE("T79c: n8_machine_free -- joins the reader, input fd left open") {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        N8Machine *m = n8_machine_new();
+        N8Machine *prev = n8_machine_bind(m);
+        tty_start_reader(fds[0]);
+        REQUIRE(write(fds[1], "a", 1) == 1);
+        CHECK(tty_wait_input(5000) == true);
+        CHECK(m->tty.reader_running.load());
+        n8_machine_bind(prev);
+
+        auto t0 = std::chrono::steady_clock::now();
+        n8_machine_free(m);     // reader still blocked on an open, quiet pipe
+        CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(4000));
+
+        // Nothing reads the pipe any more: what's written stays there
+        REQUIRE(write(fds[1], "b", 1) == 1);
+        char c = 0;
+        CHECK(read(fds[0], &c, 1) == 1);
+        CHECK(c == 'b');
+
+        // A reader that already hit EOF is joined by the next start or stop
+        tty_start_reader(fds[0]);
+        close(fds[1]);
+        for (int i = 0; i < 2000 && n8->tty.reader_running.load(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK_FALSE(n8->tty.reader_running.load());
+        tty_stop_reader();
+        CHECK(n8->tty.reader == nullptr);
+        close(fds[0]);
+    }
+
 } // TEST_SUITE("tty")